@@ -48,6 +48,47 @@
 	#define PS_HAS_BMI2 0
 	#define PS_HAS_BMI1 0
 	#define PS_HAS_POPCNT 0
+// the engine copies inside polaris-auto, one is picked at startup
+#elif defined(PS_AUTO_BMI2)
+	#define PS_HAS_BMI2 1
+	#define PS_HAS_BMI1 1
+	#define PS_HAS_POPCNT 1
+#elif defined(PS_AUTO_AVX2)
+	#define PS_HAS_BMI2 0
+	#define PS_HAS_BMI1 1
+	#define PS_HAS_POPCNT 1
+#elif defined(PS_AUTO_POPCNT)
+	#define PS_HAS_BMI2 0
+	#define PS_HAS_BMI1 0
+	#define PS_HAS_POPCNT 1
 #else
 #error no arch specified
 #endif
+
+#if defined(PS_AUTO_BMI2) || defined(PS_AUTO_AVX2) || defined(PS_AUTO_POPCNT)
+	#define PS_AUTO_FLAVOUR 1
+#else
+	#define PS_AUTO_FLAVOUR 0
+#endif
+
+namespace polaris
+{
+	// the build flavour, for reporting throughput per binary
+#if defined(PS_NATIVE)
+	constexpr auto ArchName = "native";
+#elif defined(PS_BMI2)
+	constexpr auto ArchName = "bmi2";
+#elif defined(PS_MODERN)
+	constexpr auto ArchName = "modern";
+#elif defined(PS_POPCNT)
+	constexpr auto ArchName = "popcnt";
+#elif defined(PS_AUTO_BMI2)
+	constexpr auto ArchName = "auto-bmi2";
+#elif defined(PS_AUTO_AVX2)
+	constexpr auto ArchName = "auto-avx2";
+#elif defined(PS_AUTO_POPCNT)
+	constexpr auto ArchName = "auto-popcnt";
+#else
+	constexpr auto ArchName = "compat";
+#endif
+}
@@ -0,0 +1,98 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "attacks.h"
+
+#if PS_AUTO_FLAVOUR
+#include <array>
+
+#include "../util/rng.h"
+#include "../util/timer.h"
+#endif
+
+namespace polaris::attacks
+{
+	auto init() -> void
+	{
+#if PS_HAS_BMI2
+		bmi2::init();
+#else
+		black_magic::init();
+#endif
+	}
+
+#if PS_AUTO_FLAVOUR
+	auto timeLookups() -> f64
+	{
+		// called before this copy has been picked to run
+		init();
+
+		constexpr u32 Occupancies = 256;
+		constexpr u32 Rounds = 8;
+
+		Jsf64Rng rng{0xBAD5EED};
+
+		std::array<Bitboard, Occupancies> occupancies{};
+		for (auto &occ : occupancies)
+		{
+			occ = rng.nextU64() & rng.nextU64();
+		}
+
+		const auto start = util::g_timer.time();
+
+		u64 sink{};
+
+		for (u32 round = 0; round < Rounds; ++round)
+		{
+			for (const auto occ : occupancies)
+			{
+				for (i32 square = 0; square < 64; ++square)
+				{
+					sink ^= getRookAttacks(static_cast<Square>(square), occ);
+					sink ^= getBishopAttacks(static_cast<Square>(square), occ);
+				}
+			}
+		}
+
+		const auto time = util::g_timer.time() - start;
+
+		// keep the lookups from being optimised out
+		[[maybe_unused]] volatile u64 result = sink;
+
+		return time;
+	}
+#endif
+
+	auto backendName() -> const char *
+	{
+#if PS_HAS_BMI2
+		return "bmi2";
+#else
+		return "black magic";
+#endif
+	}
+
+	auto tableBytes() -> usize
+	{
+#if PS_HAS_BMI2
+		return bmi2::tableBytes();
+#else
+		return black_magic::tableBytes();
+#endif
+	}
+}
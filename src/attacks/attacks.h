@@ -35,6 +35,29 @@
 
 namespace polaris::attacks
 {
+	// builds the slider attack tables, which must happen before any lookups. Not done by static
+	// initialisers, as those run before polaris-auto has checked what the cpu supports
+	auto init() -> void;
+
+#if PS_AUTO_FLAVOUR
+	// seconds taken by a fixed set of slider attack lookups, for polaris-auto
+	// to pick between its bmi2 and black magic copies on cpus that have both
+	[[nodiscard]] auto timeLookups() -> f64;
+#endif
+
+	// the slider attack implementation in use
+	[[nodiscard]] auto backendName() -> const char *;
+	// size of the slider attack tables in use
+	[[nodiscard]] auto tableBytes() -> usize;
+
+#if PS_HAS_BMI2
+	using bmi2::getRookAttacks;
+	using bmi2::getBishopAttacks;
+#else
+	using black_magic::getRookAttacks;
+	using black_magic::getBishopAttacks;
+#endif
+
 	constexpr auto generateKnightAttacks()
 	{
 		std::array<Bitboard, 64> dst{};
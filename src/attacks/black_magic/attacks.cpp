@@ -18,77 +18,129 @@
 
 #include "../attacks.h"
 
+#include <algorithm>
+
 #if !PS_HAS_BMI2
-namespace polaris::attacks
+namespace polaris::attacks::black_magic
 {
-	using namespace black_magic;
+#ifdef PS_COMPACT_ATTACKS
+	static_assert(RookData.attackSetCount <= 65536 && BishopData.attackSetCount <= 65536);
+
+	std::array<u16,   RookData.tableSize>   RookAttackIndices{};
+	std::array<u16, BishopData.tableSize> BishopAttackIndices{};
+
+	std::array<Bitboard,   RookData.attackSetCount>   RookAttacks{};
+	std::array<Bitboard, BishopData.attackSetCount> BishopAttacks{};
+#else
+	std::array<Bitboard,   RookData.tableSize>   RookAttacks{};
+	std::array<Bitboard, BishopData.tableSize> BishopAttacks{};
+#endif
 
 	namespace
 	{
-		auto generateRookAttacks()
+		auto generateAttacks(Square square, Bitboard occupancy, const std::array<i32, 4> &dirs)
 		{
-			std::array<Bitboard, RookData.tableSize> dst{};
+			Bitboard dst{};
 
-			for (u32 square = 0; square < 64; ++square)
+			for (const auto dir : dirs)
 			{
-				const auto &data = RookData.data[square];
-
-				const auto invMask = ~data.mask;
-				const auto maxEntries = 1 << invMask.popcount();
-
-				for (u32 i = 0; i < maxEntries; ++i)
-				{
-					const auto occupancy = util::pdep(i, invMask);
-					const auto idx = getRookIdx(occupancy, static_cast<Square>(square));
-
-					if (!dst[data.offset + idx].empty())
-						continue;
-
-					for (const auto dir: {offsets::Up, offsets::Down, offsets::Left, offsets::Right})
-					{
-						dst[data.offset + idx]
-							|= internal::generateSlidingAttacks(static_cast<Square>(square), dir, occupancy);
-					}
-				}
+				dst |= internal::generateSlidingAttacks(square, dir, occupancy);
 			}
 
 			return dst;
 		}
 
-		auto generateBishopAttacks()
+		// calls f(square, occupancy, magic index, first attack set of the square) for every occupancy
+		template <typename F>
+		auto forEachOccupancy(const Data &data, const std::array<i32, 4> &dirs, auto getIdx, F f)
 		{
-			std::array<Bitboard, BishopData.tableSize> dst{};
+			u32 setOffset = 0;
 
-			for (u32 square = 0; square < 64; ++square)
+			for (u32 i = 0; i < 64; ++i)
 			{
-				const auto &data = BishopData.data[square];
+				const auto square = static_cast<Square>(i);
+				const auto invMask = ~data.data[i].mask;
 
-				const auto invMask = ~data.mask;
 				const auto maxEntries = 1 << invMask.popcount();
 
-				for (u32 i = 0; i < maxEntries; ++i)
+				for (u32 j = 0; j < maxEntries; ++j)
 				{
-					const auto occupancy = util::pdep(i, invMask);
-					const auto idx = getBishopIdx(occupancy, static_cast<Square>(square));
-
-					if (!dst[data.offset + idx].empty())
-						continue;
-
-					for (const auto dir : {
-						offsets::UpLeft, offsets::UpRight, offsets::DownLeft, offsets::DownRight
-					})
-					{
-						dst[data.offset + idx]
-							|= internal::generateSlidingAttacks(static_cast<Square>(square), dir, occupancy);
-					}
+					const auto occupancy = util::pdep(j, invMask);
+					f(square, occupancy, data.data[i].offset + getIdx(occupancy, square), setOffset);
 				}
+
+				setOffset += attackSetCount(square, dirs);
 			}
+		}
 
-			return dst;
+#ifdef PS_COMPACT_ATTACKS
+		// numbers a square's attack sets in mixed radix, one digit per ray
+		auto attackSetIndex(Square square, Bitboard attacks, const std::array<i32, 4> &dirs)
+		{
+			u32 idx = 0;
+
+			for (const auto dir : dirs)
+			{
+				const auto ray = internal::generateSlidingAttacks(square, dir, 0);
+
+				const auto length = std::max(ray.popcount(), 1);
+				const auto reach = (attacks & ray).popcount();
+
+				idx = idx * static_cast<u32>(length) + static_cast<u32>(std::max(reach - 1, 0));
+			}
+
+			return idx;
+		}
+
+		template <usize TableSize>
+		auto generateIndices(std::array<u16, TableSize> &dst,
+			const Data &data, const std::array<i32, 4> &dirs, auto getIdx)
+		{
+			forEachOccupancy(data, dirs, getIdx,
+				[&](Square square, Bitboard occupancy, u64 idx, u32 setOffset)
+				{
+					const auto attacks = generateAttacks(square, occupancy, dirs);
+					dst[idx] = static_cast<u16>(setOffset + attackSetIndex(square, attacks, dirs));
+				});
+		}
+
+		template <usize SetCount>
+		auto generateAttackSets(std::array<Bitboard, SetCount> &dst,
+			const Data &data, const std::array<i32, 4> &dirs, auto getIdx)
+		{
+			forEachOccupancy(data, dirs, getIdx,
+				[&](Square square, Bitboard occupancy, u64, u32 setOffset)
+				{
+					const auto attacks = generateAttacks(square, occupancy, dirs);
+					dst[setOffset + attackSetIndex(square, attacks, dirs)] = attacks;
+				});
+		}
+#else
+		template <usize TableSize>
+		auto generateTable(std::array<Bitboard, TableSize> &dst,
+			const Data &data, const std::array<i32, 4> &dirs, auto getIdx)
+		{
+			forEachOccupancy(data, dirs, getIdx,
+				[&](Square square, Bitboard occupancy, u64 idx, u32)
+				{
+					dst[idx] = generateAttacks(square, occupancy, dirs);
+				});
 		}
+#endif
 	}
 
-	const std::array<Bitboard,   RookData.tableSize>   RookAttacks =   generateRookAttacks();
-	const std::array<Bitboard, BishopData.tableSize> BishopAttacks = generateBishopAttacks();
+	auto init() -> void
+	{
+#ifdef PS_COMPACT_ATTACKS
+		generateIndices(  RookAttackIndices,   RookData,   RookDirs,   getRookIdx);
+		generateIndices(BishopAttackIndices, BishopData, BishopDirs, getBishopIdx);
+
+		generateAttackSets(  RookAttacks,   RookData,   RookDirs,   getRookIdx);
+		generateAttackSets(BishopAttacks, BishopData, BishopDirs, getBishopIdx);
+#else
+		generateTable(  RookAttacks,   RookData,   RookDirs,   getRookIdx);
+		generateTable(BishopAttacks, BishopData, BishopDirs, getBishopIdx);
+#endif
+	}
 }
 #endif // !PS_HAS_BMI2
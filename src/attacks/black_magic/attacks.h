@@ -28,19 +28,45 @@
 #include "data.h"
 #include "../../util/bits.h"
 
-namespace polaris::attacks
+namespace polaris::attacks::black_magic
 {
-	extern const std::array<Bitboard, black_magic::  RookData.tableSize>   RookAttacks;
-	extern const std::array<Bitboard, black_magic::BishopData.tableSize> BishopAttacks;
+#ifdef PS_COMPACT_ATTACKS
+	// the magic index selects one of the square's distinct attack sets, which
+	// are shared between all the occupancies that produce them. 16-bit indices
+	// and the small set tables take under a third of the space of the full tables,
+	// at the cost of a second dependent load per lookup
+	extern std::array<u16,   RookData.tableSize>   RookAttackIndices;
+	extern std::array<u16, BishopData.tableSize> BishopAttackIndices;
+
+	extern std::array<Bitboard,   RookData.attackSetCount>   RookAttacks;
+	extern std::array<Bitboard, BishopData.attackSetCount> BishopAttacks;
+
+	[[nodiscard]] constexpr auto tableBytes() -> usize
+	{
+		return sizeof(RookAttackIndices) + sizeof(BishopAttackIndices)
+			+ sizeof(RookAttacks) + sizeof(BishopAttacks);
+	}
+#else
+	extern std::array<Bitboard,   RookData.tableSize>   RookAttacks;
+	extern std::array<Bitboard, BishopData.tableSize> BishopAttacks;
+
+	[[nodiscard]] constexpr auto tableBytes() -> usize
+	{
+		return sizeof(RookAttacks) + sizeof(BishopAttacks);
+	}
+#endif
+
+	// fills the tables
+	auto init() -> void;
 
 	[[nodiscard]] inline auto getRookIdx(Bitboard occupancy, Square src)
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = black_magic::RookData.data[s];
+		const auto &data = RookData.data[s];
 
-		const auto magic = black_magic::RookMagics[s];
-		const auto shift = black_magic::RookShifts[s];
+		const auto magic = RookMagics[s];
+		const auto shift = RookShifts[s];
 
 		return ((occupancy | data.mask) * magic) >> shift;
 	}
@@ -49,10 +75,10 @@ namespace polaris::attacks
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = black_magic::BishopData.data[s];
+		const auto &data = BishopData.data[s];
 
-		const auto magic = black_magic::BishopMagics[s];
-		const auto shift = black_magic::BishopShifts[s];
+		const auto magic = BishopMagics[s];
+		const auto shift = BishopShifts[s];
 
 		return ((occupancy | data.mask) * magic) >> shift;
 	}
@@ -61,19 +87,27 @@ namespace polaris::attacks
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = black_magic::RookData.data[s];
+		const auto &data = RookData.data[s];
 		const auto idx = getRookIdx(occupancy, src);
 
+#ifdef PS_COMPACT_ATTACKS
+		return RookAttacks[RookAttackIndices[data.offset + idx]];
+#else
 		return RookAttacks[data.offset + idx];
+#endif
 	}
 
 	[[nodiscard]] inline auto getBishopAttacks(Square src, Bitboard occupancy)
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = black_magic::BishopData.data[s];
+		const auto &data = BishopData.data[s];
 		const auto idx = getBishopIdx(occupancy, src);
 
+#ifdef PS_COMPACT_ATTACKS
+		return BishopAttacks[BishopAttackIndices[data.offset + idx]];
+#else
 		return BishopAttacks[data.offset + idx];
+#endif
 	}
 }
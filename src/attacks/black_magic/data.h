@@ -21,6 +21,7 @@
 #include "../../types.h"
 
 #include <array>
+#include <algorithm>
 
 #include "../../core.h"
 #include "../../bitboard.h"
@@ -99,8 +100,27 @@ namespace polaris::attacks::black_magic
 	{
 		std::array<SquareData, 64> data;
 		u32 tableSize;
+		// distinct attack sets over all squares
+		u32 attackSetCount;
 	};
 
+	// a slider's distinct attack sets from a square are fixed by how far each ray reaches
+	constexpr auto attackSetCount(Square square, const std::array<i32, 4> &dirs)
+	{
+		u32 count = 1;
+
+		for (const auto dir : dirs)
+		{
+			const auto length = internal::generateSlidingAttacks(square, dir, 0).popcount();
+			count *= static_cast<u32>(std::max(length, 1));
+		}
+
+		return count;
+	}
+
+	constexpr auto RookDirs = std::array{offsets::Up, offsets::Down, offsets::Left, offsets::Right};
+	constexpr auto BishopDirs = std::array{offsets::UpLeft, offsets::UpRight, offsets::DownLeft, offsets::DownRight};
+
 	consteval auto generateRookData()
 	{
 		Data dst{};
@@ -111,7 +131,7 @@ namespace polaris::attacks::black_magic
 
 			dst.data[i].mask = boards::All;
 
-			for (const auto dir : {offsets::Up, offsets::Down, offsets::Left, offsets::Right})
+			for (const auto dir : RookDirs)
 			{
 				const auto attacks = internal::generateSlidingAttacks(square, dir, 0);
 				dst.data[i].mask &= ~(attacks & ~internal::edges(dir));
@@ -119,6 +139,8 @@ namespace polaris::attacks::black_magic
 
 			dst.data[i].offset = dst.tableSize;
 			dst.tableSize += 1 << (64 - RookShifts[i]);
+
+			dst.attackSetCount += attackSetCount(square, RookDirs);
 		}
 
 		return dst;
@@ -134,7 +156,7 @@ namespace polaris::attacks::black_magic
 
 			dst.data[i].mask = boards::All;
 
-			for (const auto dir : {offsets::UpLeft, offsets::UpRight, offsets::DownLeft, offsets::DownRight})
+			for (const auto dir : BishopDirs)
 			{
 				const auto attacks = internal::generateSlidingAttacks(square, dir, 0);
 				dst.data[i].mask &= ~(attacks & ~internal::edges(dir));
@@ -142,6 +164,8 @@ namespace polaris::attacks::black_magic
 
 			dst.data[i].offset = dst.tableSize;
 			dst.tableSize += 1 << (64 - BishopShifts[i]);
+
+			dst.attackSetCount += attackSetCount(square, BishopDirs);
 		}
 
 		return dst;
@@ -19,16 +19,15 @@
 #include "../attacks.h"
 
 #if PS_HAS_BMI2
-namespace polaris::attacks
+namespace polaris::attacks::bmi2
 {
-	using namespace bmi2;
+	std::array<     u16,   RookData.tableSize>   RookAttacks{};
+	std::array<     u16, BishopData.tableSize> BishopAttacks{};
 
 	namespace
 	{
-		auto generateRookAttacks()
+		auto generateRookAttacks(std::array<u16, RookData.tableSize> &dst)
 		{
-			std::array<u16, RookData.tableSize> dst{};
-
 			for (u32 square = 0; square < 64; ++square)
 			{
 				const auto &data = RookData.data[square];
@@ -48,37 +47,37 @@ namespace polaris::attacks
 					dst[data.offset + i] = static_cast<u16>(util::pext(attacks, data.dstMask));
 				}
 			}
-
-			return dst;
 		}
 
-		auto generateBishopAttacks()
+		auto generateBishopAttacks(std::array<u16, BishopData.tableSize> &dst)
 		{
-			std::array<Bitboard, BishopData.tableSize> dst{};
-
 			for (u32 square = 0; square < 64; ++square)
 			{
 				const auto &data = BishopData.data[square];
-				const auto entries = 1 << data.mask.popcount();
+				const auto entries = 1 << data.srcMask.popcount();
 
 				for (u32 i = 0; i < entries; ++i)
 				{
-					const auto occupancy = util::pdep(i, data.mask);
+					const auto occupancy = util::pdep(i, data.srcMask);
+
+					Bitboard attacks{};
 
 					for (const auto dir
 						: {offsets::UpLeft, offsets::UpRight, offsets::DownLeft, offsets::DownRight})
 					{
-						dst[data.offset + i]
-							|= internal::generateSlidingAttacks(static_cast<Square>(square), dir, occupancy);
+						attacks |= internal::generateSlidingAttacks(static_cast<Square>(square), dir, occupancy);
 					}
+
+					dst[data.offset + i] = static_cast<u16>(util::pext(attacks, data.dstMask));
 				}
 			}
-
-			return dst;
 		}
 	}
 
-	const std::array<     u16,   RookData.tableSize>   RookAttacks =   generateRookAttacks();
-	const std::array<Bitboard, BishopData.tableSize> BishopAttacks = generateBishopAttacks();
+	auto init() -> void
+	{
+		generateRookAttacks(RookAttacks);
+		generateBishopAttacks(BishopAttacks);
+	}
 }
 #endif // PS_HAS_BMI2
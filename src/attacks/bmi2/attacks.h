@@ -28,16 +28,24 @@
 #include "data.h"
 #include "../../util/bits.h"
 
-namespace polaris::attacks
+namespace polaris::attacks::bmi2
 {
-	extern const std::array<     u16, bmi2::  RookData.tableSize>   RookAttacks;
-	extern const std::array<Bitboard, bmi2::BishopData.tableSize> BishopAttacks;
+	extern std::array<     u16,   RookData.tableSize>   RookAttacks;
+	extern std::array<     u16, BishopData.tableSize> BishopAttacks;
+
+	// fills the tables
+	auto init() -> void;
+
+	[[nodiscard]] constexpr auto tableBytes() -> usize
+	{
+		return sizeof(RookAttacks) + sizeof(BishopAttacks);
+	}
 
 	inline auto getRookAttacks(Square src, Bitboard occupancy) -> Bitboard
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = bmi2::RookData.data[s];
+		const auto &data = RookData.data[s];
 
 		const auto idx = util::pext(occupancy, data.srcMask);
 		const auto attacks = util::pdep(RookAttacks[data.offset + idx], data.dstMask);
@@ -45,13 +53,15 @@ namespace polaris::attacks
 		return attacks;
 	}
 
-	inline auto getBishopAttacks(Square src, Bitboard occupancy)
+	inline auto getBishopAttacks(Square src, Bitboard occupancy) -> Bitboard
 	{
 		const auto s = static_cast<i32>(src);
 
-		const auto &data = bmi2::BishopData.data[s];
-		const auto idx = util::pext(occupancy, data.mask);
+		const auto &data = BishopData.data[s];
 
-		return BishopAttacks[data.offset + idx];
+		const auto idx = util::pext(occupancy, data.srcMask);
+		const auto attacks = util::pdep(BishopAttacks[data.offset + idx], data.dstMask);
+
+		return attacks;
 	}
 }
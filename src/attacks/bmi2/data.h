@@ -44,7 +44,8 @@ namespace polaris::attacks::bmi2
 
 	struct BishopSquareData
 	{
-		Bitboard mask;
+		Bitboard srcMask;
+		Bitboard dstMask;
 		u32 offset;
 	};
 
@@ -88,11 +89,13 @@ namespace polaris::attacks::bmi2
 			for (const auto dir: {offsets::UpLeft, offsets::UpRight, offsets::DownLeft, offsets::DownRight})
 			{
 				const auto attacks = internal::generateSlidingAttacks(square, dir, 0);
-				dst.data[i].mask |= attacks & ~internal::edges(dir);
+
+				dst.data[i].srcMask |= attacks & ~internal::edges(dir);
+				dst.data[i].dstMask |= attacks;
 			}
 
 			dst.data[i].offset = dst.tableSize;
-			dst.tableSize += 1 << dst.data[i].mask.popcount();
+			dst.tableSize += 1 << dst.data[i].srcMask.popcount();
 		}
 
 		return dst;
@@ -0,0 +1,132 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "../types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../core.h"
+#include "../bitboard.h"
+
+// set-wise slider attacks - kogge-stone occluded fills give the union of the
+// attacks of every slider in a set in one pass, with no table lookups. they
+// cannot give per-piece attacks, so they only fit where a side's union is enough
+namespace polaris::attacks
+{
+	namespace fill
+	{
+		// positive shifts are towards h8
+		template <i32 Shift>
+		constexpr auto shift(u64 v) -> u64
+		{
+			if constexpr (Shift > 0)
+				return v << Shift;
+			else return v >> -Shift;
+		}
+
+		// Mask clears the squares a shift would wrap around onto
+		template <i32 Shift, u64 Mask>
+		constexpr auto slidingAttacks(u64 sliders, u64 empty) -> u64
+		{
+			empty &= Mask;
+
+			sliders |= empty & shift<Shift>(sliders);
+			empty &= shift<Shift>(empty);
+			sliders |= empty & shift<Shift * 2>(sliders);
+			empty &= shift<Shift * 2>(empty);
+			sliders |= empty & shift<Shift * 4>(sliders);
+
+			return shift<Shift>(sliders) & Mask;
+		}
+
+		constexpr auto NotFileA = ~U64(0x0101010101010101);
+		constexpr auto NotFileH = ~U64(0x8080808080808080);
+		constexpr auto All = ~U64(0);
+
+#if defined(__AVX2__)
+		// one direction per lane. shifting by 64 or more zeroes a lane, which
+		// lets each lane shift either way: Left and Right hold 64 for the unused side
+		template <i32 L0, i32 L1, i32 L2, i32 L3, i32 R0, i32 R1, i32 R2, i32 R3>
+		inline auto slidingAttacks4(u64 sliders, u64 empty, __m256i masks) -> u64
+		{
+			const auto shiftBy = [](__m256i v, i32 mult)
+			{
+				const auto clamp = [](i32 s, i32 m) { return static_cast<i64>(s >= 64 ? 64 : s * m); };
+
+				const auto left = _mm256_set_epi64x(clamp(L3, mult), clamp(L2, mult), clamp(L1, mult), clamp(L0, mult));
+				const auto right = _mm256_set_epi64x(clamp(R3, mult), clamp(R2, mult), clamp(R1, mult), clamp(R0, mult));
+
+				return _mm256_or_si256(_mm256_sllv_epi64(v, left), _mm256_srlv_epi64(v, right));
+			};
+
+			auto gen = _mm256_set1_epi64x(static_cast<i64>(sliders));
+			auto pro = _mm256_and_si256(_mm256_set1_epi64x(static_cast<i64>(empty)), masks);
+
+			gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftBy(gen, 1)));
+			pro = _mm256_and_si256(pro, shiftBy(pro, 1));
+			gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftBy(gen, 2)));
+			pro = _mm256_and_si256(pro, shiftBy(pro, 2));
+			gen = _mm256_or_si256(gen, _mm256_and_si256(pro, shiftBy(gen, 4)));
+
+			const auto attacks = _mm256_and_si256(shiftBy(gen, 1), masks);
+
+			const auto half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+			return static_cast<u64>(_mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half))));
+		}
+#endif
+	}
+
+	[[nodiscard]] inline auto rookAttacksFill(Bitboard rooks, Bitboard occupancy) -> Bitboard
+	{
+		const auto empty = ~occupancy;
+
+#if defined(__AVX2__)
+		// up, right, down, left
+		const auto masks = _mm256_set_epi64x(static_cast<i64>(fill::NotFileH),
+			static_cast<i64>(fill::All), static_cast<i64>(fill::NotFileA), static_cast<i64>(fill::All));
+		return fill::slidingAttacks4<8, 1, 64, 64, 64, 64, 8, 1>(rooks, empty, masks);
+#else
+		return fill::slidingAttacks< 8, fill::All>(rooks, empty)
+			| fill::slidingAttacks<-8, fill::All>(rooks, empty)
+			| fill::slidingAttacks< 1, fill::NotFileA>(rooks, empty)
+			| fill::slidingAttacks<-1, fill::NotFileH>(rooks, empty);
+#endif
+	}
+
+	[[nodiscard]] inline auto bishopAttacksFill(Bitboard bishops, Bitboard occupancy) -> Bitboard
+	{
+		const auto empty = ~occupancy;
+
+#if defined(__AVX2__)
+		// up right, up left, down left, down right
+		const auto masks = _mm256_set_epi64x(static_cast<i64>(fill::NotFileA),
+			static_cast<i64>(fill::NotFileH), static_cast<i64>(fill::NotFileH), static_cast<i64>(fill::NotFileA));
+		return fill::slidingAttacks4<9, 7, 64, 64, 64, 64, 9, 7>(bishops, empty, masks);
+#else
+		return fill::slidingAttacks< 9, fill::NotFileA>(bishops, empty)
+			| fill::slidingAttacks< 7, fill::NotFileH>(bishops, empty)
+			| fill::slidingAttacks<-7, fill::NotFileA>(bishops, empty)
+			| fill::slidingAttacks<-9, fill::NotFileH>(bishops, empty);
+#endif
+	}
+}
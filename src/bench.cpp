@@ -19,14 +19,30 @@
 #include "bench.h"
 
 #include <array>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <string_view>
 
+#include "arch.h"
 #include "position/position.h"
+#include "movegen.h"
+#include "see.h"
+#include "uci.h"
+#include "eval/eval.h"
+#include "eval/nnue.h"
+#include "attacks/attacks.h"
+#include "attacks/fill.h"
+#include "util/timer.h"
+#include "util/parse.h"
 
 namespace polaris::bench
 {
-	auto run(search::Searcher &searcher, i32 depth) -> void
+	namespace
 	{
-		const std::array Fens { // fens from alexandria, ultimately from bitgenie
+		constexpr std::array Fens { // fens from alexandria, ultimately from bitgenie
 			"r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
 			"4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
 			"r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42",
@@ -79,23 +95,562 @@ namespace polaris::bench
 			"2r2b2/5p2/5k2/p1r1pP2/P2pB3/1P3P2/K1P3R1/7R w - - 23 93"
 		};
 
+		struct SeeCase
+		{
+			const char *fen;
+			const char *move;
+			Score expected;
+		};
+
+		// swap-off values under the engine's piece values. the pinned cases
+		// come in pairs with an unpinned position that has the opposite result
+		constexpr auto SeeCases = std::array {
+			SeeCase{"4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 100},
+			SeeCase{"4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 0},
+			SeeCase{"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100},
+			SeeCase{"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -350},
+			// defender pinned off the capture square
+			SeeCase{"4k3/8/2p5/3p4/8/4N3/8/4K3 w - - 0 1", "e3d5", -350},
+			SeeCase{"4k3/8/2p5/3p4/B7/4N3/8/4K3 w - - 0 1", "e3d5", 100},
+			SeeCase{"4k3/8/4n3/8/3p4/8/3R4/K7 w - - 0 1", "d2d4", -550},
+			SeeCase{"4k3/8/4n3/8/3p4/8/3R4/K3R3 w - - 0 1", "d2d4", 100},
+			// recapture by the side to move's pinned piece
+			SeeCase{"k7/8/8/1n6/3P4/8/4N3/4K3 b - - 0 1", "b5d4", -350},
+			SeeCase{"k3r3/8/8/1n6/3P4/8/4N3/4K3 b - - 0 1", "b5d4", 100},
+			// quiet move onto a square guarded by a pinned pawn
+			SeeCase{"4k3/8/2p5/8/8/8/8/3RK3 w - - 0 1", "d1d5", -650},
+			SeeCase{"4k3/8/2p5/8/B7/8/8/3RK3 w - - 0 1", "d1d5", 0},
+			// the pinner captures off the pin line, releasing the pin
+			SeeCase{"4k3/8/4n3/8/3pR3/8/8/K7 w - - 0 1", "e4d4", -550},
+			// a pinned piece may still recapture along its pin line
+			SeeCase{"k4b2/4r3/8/3N4/8/4R3/8/4K3 w - - 0 1", "d5e7", 650},
+			// a piece further along the pin line moving doesn't release the pin
+			SeeCase{"7k/8/8/8/3Pq3/4r3/4N3/4K3 b - - 0 1", "e4d4", 100},
+		};
+
+		struct PositionResult
+		{
+			std::string fen;
+			i32 depth;
+			i32 seldepth;
+			usize nodes;
+			f64 time;
+			Move move;
+		};
+
+		inline auto millis(f64 time)
+		{
+			return static_cast<usize>(time * 1000.0);
+		}
+
+		inline auto nps(usize nodes, f64 time)
+		{
+			return static_cast<usize>(static_cast<f64>(nodes) / time);
+		}
+
+		// instruction set extensions this binary was compiled to use
+		auto buildFeatures()
+		{
+			std::vector<std::string_view> features{};
+
+#if defined(__SSE2__) || defined(_M_X64)
+			features.emplace_back("sse2");
+#endif
+#ifdef __SSSE3__
+			features.emplace_back("ssse3");
+#endif
+#ifdef __SSE4_1__
+			features.emplace_back("sse4.1");
+#endif
+#ifdef __SSE4_2__
+			features.emplace_back("sse4.2");
+#endif
+#if PS_HAS_POPCNT
+			features.emplace_back("popcnt");
+#endif
+#ifdef __AVX__
+			features.emplace_back("avx");
+#endif
+#ifdef __AVX2__
+			features.emplace_back("avx2");
+#endif
+#if PS_HAS_BMI1
+			features.emplace_back("bmi");
+#endif
+#if PS_HAS_BMI2
+			features.emplace_back("bmi2");
+#endif
+#ifdef __AVX512F__
+			features.emplace_back("avx512f");
+#endif
+#ifdef __AVX512BW__
+			features.emplace_back("avx512bw");
+#endif
+
+			return features;
+		}
+
+		// only ever given strings from this file, fens that parsed and
+		// move strings, none of which can contain characters needing escapes
+		auto printJson(const std::vector<PositionResult> &results, i32 depth,
+			u32 threads, usize nodes, f64 time, f64 evalCacheHitRate) -> void
+		{
+			std::cout << "{\n";
+			std::cout << "  \"engine\": \"Polaris\",\n";
+			std::cout << "  \"version\": \"" << PS_STRINGIFY(PS_VERSION) << "\",\n";
+			std::cout << "  \"arch\": \"" << ArchName << "\",\n";
+			std::cout << "  \"attacks\": \"" << attacks::backendName() << "\",\n";
+
+			std::cout << "  \"features\": [";
+
+			const auto features = buildFeatures();
+			for (usize i = 0; i < features.size(); ++i)
+			{
+				std::cout << (i == 0 ? "" : ", ") << '"' << features[i] << '"';
+			}
+
+			std::cout << "],\n";
+
+			std::cout << "  \"depth\": " << depth << ",\n";
+			std::cout << "  \"threads\": " << threads << ",\n";
+
+			std::cout << "  \"positions\": [\n";
+
+			for (usize i = 0; i < results.size(); ++i)
+			{
+				const auto &result = results[i];
+
+				std::cout << "    {\"fen\": \"" << result.fen << "\""
+					<< ", \"depth\": " << result.depth
+					<< ", \"seldepth\": " << result.seldepth
+					<< ", \"nodes\": " << result.nodes
+					<< ", \"time\": " << millis(result.time)
+					<< ", \"nps\": " << nps(result.nodes, result.time)
+					<< ", \"bestmove\": \"" << uci::moveToString(result.move) << "\"}"
+					<< (i + 1 < results.size() ? ",\n" : "\n");
+			}
+
+			std::cout << "  ],\n";
+
+			std::cout << "  \"nodes\": " << nodes << ",\n";
+			std::cout << "  \"time\": " << millis(time) << ",\n";
+			std::cout << "  \"nps\": " << nps(nodes, time) << ",\n";
+			std::cout << "  \"eval_cache_hit_rate\": " << evalCacheHitRate << "\n";
+			std::cout << "}" << std::endl;
+		}
+	}
+
+	auto defaultFens() -> std::span<const char *const>
+	{
+		return Fens;
+	}
+
+	auto loadPositions(const std::string &path) -> std::optional<std::vector<std::string>>
+	{
+		std::ifstream stream{path};
+
+		if (!stream)
+			return {};
+
+		std::vector<std::string> fens{};
+
+		for (std::string line{}; std::getline(stream, line);)
+		{
+			std::istringstream lineStream{line};
+
+			std::vector<std::string> fields{};
+			for (std::string field{}; fields.size() < 6 && lineStream >> field;)
+			{
+				fields.push_back(field);
+			}
+
+			if (fields.empty() || fields[0].starts_with('#'))
+				continue;
+
+			if (fields.size() < 4)
+			{
+				std::cerr << "skipping short line \"" << line << "\"" << std::endl;
+				continue;
+			}
+
+			// epd lines carry opcodes where a fen has its move counters
+			const bool hasCounters = fields.size() == 6
+				&& util::tryParseU32(fields[4])
+				&& util::tryParseU32(fields[5]);
+
+			auto fen = fields[0] + ' ' + fields[1] + ' ' + fields[2] + ' ' + fields[3];
+			fen += hasCounters ? ' ' + fields[4] + ' ' + fields[5] : " 0 1";
+
+			fens.push_back(std::move(fen));
+		}
+
+		return fens;
+	}
+
+	auto run(search::Searcher &searcher, i32 depth, const std::vector<std::string> &fens, bool json) -> void
+	{
+		const auto positions = fens.empty() ? std::vector<std::string>{Fens.begin(), Fens.end()} : fens;
+
+		std::vector<PositionResult> results{};
+		results.reserve(positions.size());
+
 		usize nodes{};
 		f64 time{};
 
-		for (const auto &fen : Fens)
+		usize evalCacheProbes{};
+		usize evalCacheHits{};
+
+		search::SearchStats stats{};
+
+		for (usize i = 0; i < positions.size(); ++i)
 		{
-			const auto pos = *Position::fromFen(fen);
+			const auto pos = Position::fromFen(positions[i]);
+
+			if (!pos)
+			{
+				if (!json)
+					std::cout << "info string skipping invalid fen " << positions[i] << std::endl;
+				continue;
+			}
 
 			searcher.newGame();
 
 			search::BenchData data{};
-			searcher.runBench(data, pos, depth);
+			searcher.runBench(data, *pos, depth);
+
+			const PositionResult result{
+				.fen = positions[i],
+				.depth = data.search.depth,
+				.seldepth = data.search.seldepth,
+				.nodes = data.search.nodes,
+				.time = data.time,
+				.move = data.search.move
+			};
+
+			if (!json)
+				std::cout << "info string position " << (i + 1) << '/' << positions.size()
+					<< " depth " << result.depth << " seldepth " << result.seldepth
+					<< " nodes " << result.nodes
+					<< " time " << millis(result.time)
+					<< " nps " << nps(result.nodes, result.time)
+					<< " bestmove " << uci::moveToString(result.move) << std::endl;
+
+			results.push_back(result);
 
 			nodes += data.search.nodes;
 			time += data.time;
+
+			evalCacheProbes += data.evalCacheProbes;
+			evalCacheHits += data.evalCacheHits;
+
+			stats += data.stats;
+		}
+
+		const auto evalCacheHitRate = evalCacheProbes == 0 ? 0.0
+			: static_cast<f64>(evalCacheHits) / static_cast<f64>(evalCacheProbes) * 100.0;
+
+		const auto threads = searcher.threadCount();
+
+		if (json)
+		{
+			printJson(results, depth, threads, nodes, time, evalCacheHitRate);
+			return;
 		}
 
+		// the nodes and nps line has to come last
+		if constexpr (search::StatsEnabled)
+			search::printStats(stats);
+
+		std::cout << "info string eval cache hit rate " << evalCacheHitRate << "%" << std::endl;
+
+		if (threads > 1)
+			std::cout << "info string " << threads << " threads, "
+				<< static_cast<usize>(static_cast<f64>(nodes) / time / static_cast<f64>(threads))
+				<< " nps per thread" << std::endl;
+
 		std::cout << "info string " << time << " seconds" << std::endl;
-		std::cout << nodes << " nodes " << static_cast<usize>(static_cast<f64>(nodes) / time) << " nps" << std::endl;
+		std::cout << nodes << " nodes " << nps(nodes, time) << " nps" << std::endl;
+	}
+
+	auto runEval(u32 iterations) -> void
+	{
+		if (!eval::nnue::networkLoaded())
+			std::cout << "info string no network loaded, timing a zeroed network" << std::endl;
+
+		std::vector<Position> hcePositions{};
+		std::vector<Position> nnuePositions{};
+
+		for (const auto &fen : Fens)
+		{
+			auto pos = *Position::fromFen(fen);
+
+			pos.setNnue(false);
+			hcePositions.push_back(pos);
+
+			pos.setNnue(true);
+			nnuePositions.push_back(pos);
+		}
+
+		// keeps the evals from being optimised out
+		volatile Score sink{};
+
+		const auto report = [](const char *name, usize evals, f64 time)
+		{
+			std::cout << "info string " << name << ": " << evals << " evals in " << time << " seconds, "
+				<< static_cast<usize>(static_cast<f64>(evals) / time) << " evals/sec" << std::endl;
+		};
+
+		const auto timeStatic = [&](const char *name, const std::vector<Position> &positions)
+		{
+			const auto start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations; ++i)
+			{
+				for (const auto &pos : positions)
+				{
+					sink = eval::staticEval(pos);
+				}
+			}
+
+			report(name, positions.size() * iterations, util::g_timer.time() - start);
+		};
+
+		// make, eval, unmake over every legal move - what the search actually pays
+		const auto timeIncremental = [&](const char *name, std::vector<Position> &positions)
+		{
+			usize evals{};
+
+			const auto start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations; ++i)
+			{
+				for (auto &pos : positions)
+				{
+					ScoredMoveList moves{};
+					generateAll(moves, pos);
+
+					for (const auto [move, see, score] : moves)
+					{
+						if (const auto guard = pos.applyMove(move))
+						{
+							sink = eval::staticEval(pos);
+							++evals;
+						}
+					}
+				}
+			}
+
+			report(name, evals, util::g_timer.time() - start);
+		};
+
+		timeStatic("hce", hcePositions);
+		timeStatic("nnue", nnuePositions);
+
+		{
+			eval::nnue::Accumulator accumulator{};
+
+			const auto start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations; ++i)
+			{
+				for (const auto &pos : nnuePositions)
+				{
+					accumulator.refresh(pos.boards());
+					sink = eval::nnue::evaluate(accumulator, pos.toMove());
+				}
+			}
+
+			report("nnue (full refresh)", nnuePositions.size() * iterations, util::g_timer.time() - start);
+		}
+
+		timeIncremental("hce (make/unmake)", hcePositions);
+		timeIncremental("nnue (make/unmake)", nnuePositions);
+	}
+
+	auto runAttacks(u32 iterations) -> void
+	{
+		struct Lookup
+		{
+			Square square;
+			Bitboard occupancy;
+		};
+
+		std::vector<Lookup> lookups{};
+		lookups.reserve(Fens.size() * 64);
+
+		for (const auto &fen : Fens)
+		{
+			const auto occupancy = Position::fromFen(fen)->boards().occupancy();
+
+			for (i32 square = 0; square < 64; ++square)
+			{
+				lookups.push_back({static_cast<Square>(square), occupancy});
+			}
+		}
+
+		std::cout << "info string " << attacks::backendName() << " attacks, "
+			<< (attacks::tableBytes() / 1024) << " KiB of tables" << std::endl;
+
+		// keeps the lookups from being optimised out
+		volatile u64 sink{};
+
+		const auto report = [&](const char *name, f64 time)
+		{
+			const auto count = static_cast<f64>(lookups.size()) * static_cast<f64>(iterations);
+			std::cout << "info string " << name << ": " << (time * 1e9 / count) << " ns/lookup" << std::endl;
+		};
+
+		const auto timeGetter = [&](const char *name, auto getter)
+		{
+			u64 result{};
+
+			auto start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations; ++i)
+			{
+				for (const auto [square, occupancy] : lookups)
+				{
+					result ^= getter(square, occupancy);
+				}
+			}
+
+			report((std::string{name} + " throughput").c_str(), util::g_timer.time() - start);
+			sink = result;
+
+			// each lookup's occupancy depends on the previous result
+			result = 0;
+			start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations; ++i)
+			{
+				for (const auto [square, occupancy] : lookups)
+				{
+					result = getter(square, occupancy ^ (result & 1));
+				}
+			}
+
+			report((std::string{name} + " latency").c_str(), util::g_timer.time() - start);
+			sink = result;
+		};
+
+		timeGetter("rook", [](Square square, Bitboard occupancy) { return attacks::getRookAttacks(square, occupancy); });
+		timeGetter("bishop", [](Square square, Bitboard occupancy) { return attacks::getBishopAttacks(square, occupancy); });
+
+		// whole-side slider attack unions, per-piece lookups against set-wise fills
+		struct Side
+		{
+			Bitboard orthogonals;
+			Bitboard diagonals;
+			Bitboard occupancy;
+		};
+
+		std::vector<Side> sides{};
+
+		for (const auto &fen : Fens)
+		{
+			const auto pos = *Position::fromFen(fen);
+			const auto &boards = pos.boards();
+
+			for (const auto c : {Color::Black, Color::White})
+			{
+				const auto queens = boards.forPiece(BasePiece::Queen, c);
+				sides.push_back({boards.forPiece(BasePiece::Rook, c) | queens,
+					boards.forPiece(BasePiece::Bishop, c) | queens, boards.occupancy()});
+			}
+		}
+
+		const auto timeUnions = [&](const char *name, auto getter)
+		{
+			u64 result{};
+
+			const auto start = util::g_timer.time();
+
+			for (u32 i = 0; i < iterations * 64; ++i)
+			{
+				for (const auto &side : sides)
+				{
+					result ^= getter(side);
+				}
+			}
+
+			const auto time = util::g_timer.time() - start;
+			sink = result;
+
+			const auto count = static_cast<f64>(sides.size()) * static_cast<f64>(iterations * 64);
+			std::cout << "info string " << name << ": " << (time * 1e9 / count) << " ns/side" << std::endl;
+		};
+
+		const auto lookupUnion = [](const Side &side)
+		{
+			Bitboard dst{};
+
+			auto orthogonals = side.orthogonals;
+			while (orthogonals)
+			{
+				dst |= attacks::getRookAttacks(orthogonals.popLowestSquare(), side.occupancy);
+			}
+
+			auto diagonals = side.diagonals;
+			while (diagonals)
+			{
+				dst |= attacks::getBishopAttacks(diagonals.popLowestSquare(), side.occupancy);
+			}
+
+			return dst;
+		};
+
+		const auto fillUnion = [](const Side &side)
+		{
+			return attacks::rookAttacksFill(side.orthogonals, side.occupancy)
+				| attacks::bishopAttacksFill(side.diagonals, side.occupancy);
+		};
+
+		for (const auto &side : sides)
+		{
+			if (lookupUnion(side) != fillUnion(side))
+			{
+				std::cout << "info string fill mismatch" << std::endl;
+				break;
+			}
+		}
+
+		timeUnions("slider union lookups", lookupUnion);
+		timeUnions("slider union fills", fillUnion);
+	}
+
+	auto runSee() -> bool
+	{
+		u32 failed{};
+
+		for (const auto &[fen, moveStr, expected] : SeeCases)
+		{
+			const auto pos = Position::fromFen(fen);
+
+			if (!pos)
+			{
+				std::cout << "FAIL  invalid fen " << fen << std::endl;
+				++failed;
+				continue;
+			}
+
+			const auto move = pos->moveFromUci(moveStr);
+
+			const auto value = see::value(*pos, move);
+
+			// the threshold test has to agree with the exact value on both sides of it
+			const bool passed = value == expected
+				&& see::see(*pos, move, expected)
+				&& !see::see(*pos, move, static_cast<Score>(expected + 1));
+
+			if (!passed)
+				++failed;
+
+			std::cout << (passed ? "pass  " : "FAIL  ") << fen << ' ' << moveStr
+				<< ": " << value << " (expected " << expected << ")" << std::endl;
+		}
+
+		std::cout << '\n' << (SeeCases.size() - failed) << '/' << SeeCases.size() << " passed" << std::endl;
+
+		return failed == 0;
 	}
 }
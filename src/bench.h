@@ -20,11 +20,41 @@
 
 #include "types.h"
 
+#include <string>
+#include <vector>
+#include <optional>
+#include <span>
+
 #include "search.h"
 
 namespace polaris::bench
 {
 	constexpr i32 DefaultBenchDepth = 15;
 
-	auto run(search::Searcher &searcher, i32 depth = DefaultBenchDepth) -> void;
+	constexpr u32 DefaultEvalBenchIterations = 5000;
+	constexpr u32 DefaultAttackBenchIterations = 2000;
+
+	// the built-in bench positions
+	[[nodiscard]] auto defaultFens() -> std::span<const char *const>;
+
+	// one position per line, either a fen or an epd line (of which only the board,
+	// side to move, castling, en passant and any move counters are used)
+	// blank lines and lines starting with # are skipped
+	[[nodiscard]] auto loadPositions(const std::string &path) -> std::optional<std::vector<std::string>>;
+
+	// searches each position to a fixed depth on all of the searcher's threads,
+	// using the built-in positions if none are given. with json set, the results
+	// and the build (flavour, attack backend, instruction set extensions) are
+	// printed as a single json object and nothing else
+	auto run(search::Searcher &searcher, i32 depth = DefaultBenchDepth,
+		const std::vector<std::string> &fens = {}, bool json = false) -> void;
+
+	// static eval throughput, hce against nnue, over the bench positions
+	auto runEval(u32 iterations = DefaultEvalBenchIterations) -> void;
+
+	// slider attack lookup throughput and latency over every square of the bench positions
+	auto runAttacks(u32 iterations = DefaultAttackBenchIterations) -> void;
+
+	// static exchange evaluation of positions with known results, including pins
+	auto runSee() -> bool;
 }
@@ -0,0 +1,169 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// the entry point of polaris-auto, built for the core 2 baseline. The binary holds a
+// complete copy of the engine per flavour, each compiled into its own namespace, and
+// this picks the fastest copy the cpu can run. Nothing else in the binary may assume
+// more than the baseline before that, see the polaris-auto notes in CMakeLists.txt
+
+#include "types.h"
+
+#include <iostream>
+#include <array>
+#include <algorithm>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#define PS_DECLARE_AUTO_FLAVOUR(Flavour) \
+	namespace polaris_auto_##Flavour \
+	{ \
+		auto run(polaris::i32 argc, const char *argv[]) -> polaris::i32; \
+		namespace attacks \
+		{ \
+			auto timeLookups() -> polaris::f64; \
+		} \
+	}
+
+PS_DECLARE_AUTO_FLAVOUR(bmi2)
+PS_DECLARE_AUTO_FLAVOUR(avx2)
+PS_DECLARE_AUTO_FLAVOUR(popcnt)
+
+#undef PS_DECLARE_AUTO_FLAVOUR
+
+using namespace polaris;
+
+namespace
+{
+	struct CpuFeatures
+	{
+		// everything the popcnt copy is compiled for
+		bool sse41;
+		bool sse42;
+		bool popcnt;
+		// everything the bmi2 and avx2 copies are compiled for
+		bool x86_64_v3;
+	};
+
+	auto cpuid(u32 leaf, u32 subleaf)
+	{
+		std::array<u32, 4> regs{};
+
+#if defined(_MSC_VER) && !defined(__clang__)
+		__cpuidex(reinterpret_cast<i32 *>(regs.data()), static_cast<i32>(leaf), static_cast<i32>(subleaf));
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+		return regs;
+	}
+
+	// whether the os saves the avx registers on context switches
+	auto osSupportsAvx()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		const auto xcr0 = _xgetbv(0);
+#else
+		u32 eax, edx;
+		__asm__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		const auto xcr0 = (static_cast<u64>(edx) << 32) | eax;
+#endif
+
+		return (xcr0 & 0x6) == 0x6;
+	}
+
+	auto detectCpuFeatures()
+	{
+		constexpr u32 Ecx = 2;
+		constexpr u32 Ebx = 1;
+
+		const auto bit = [](u32 reg, i32 idx) { return (reg & (u32{1} << idx)) != 0; };
+
+		const auto maxLeaf = cpuid(0, 0)[0];
+		const auto maxExtLeaf = cpuid(0x80000000, 0)[0];
+
+		const auto leaf1 = cpuid(1, 0);
+
+		const bool sse41 = bit(leaf1[Ecx], 19);
+		const bool sse42 = bit(leaf1[Ecx], 20);
+		const bool popcnt = bit(leaf1[Ecx], 23);
+
+		const bool fma = bit(leaf1[Ecx], 12);
+		const bool movbe = bit(leaf1[Ecx], 22);
+		const bool osxsave = bit(leaf1[Ecx], 27);
+		const bool avx = bit(leaf1[Ecx], 28);
+		const bool f16c = bit(leaf1[Ecx], 29);
+
+		bool avx2 = false;
+		bool bmi = false;
+		bool bmi2 = false;
+
+		if (maxLeaf >= 7)
+		{
+			const auto leaf7 = cpuid(7, 0);
+
+			bmi = bit(leaf7[Ebx], 3);
+			avx2 = bit(leaf7[Ebx], 5);
+			bmi2 = bit(leaf7[Ebx], 8);
+		}
+
+		const bool lzcnt = maxExtLeaf >= 0x80000001 && bit(cpuid(0x80000001, 0)[Ecx], 5);
+
+		const bool x86_64_v3 = sse41 && sse42 && popcnt && fma && movbe && avx && f16c && avx2 && bmi && bmi2 && lzcnt
+			&& osxsave && osSupportsAvx();
+
+		return CpuFeatures{sse41, sse42, popcnt, x86_64_v3};
+	}
+}
+
+auto main(i32 argc, const char *argv[]) -> i32
+{
+	const auto features = detectCpuFeatures();
+
+	// some cpus have popcnt without sse4 (amd k10)
+	const auto missing = !features.sse41 ? "sse4.1"
+		: !features.sse42 ? "sse4.2"
+		: !features.popcnt ? "popcnt"
+		: nullptr;
+
+	if (missing)
+	{
+		std::cerr << "this cpu does not support " << missing << ", use a compat build" << std::endl;
+		return 1;
+	}
+
+	if (!features.x86_64_v3)
+		return polaris_auto_popcnt::run(argc, argv);
+
+	// pext and pdep are microcoded on amd before zen 3, where black magics
+	// win by a wide margin. Best of two, in case the first run pays for
+	// page faults or clock ramp-up
+	f64 bmi2Time = polaris_auto_bmi2::attacks::timeLookups();
+	f64 magicTime = polaris_auto_avx2::attacks::timeLookups();
+
+	bmi2Time = std::min(bmi2Time, polaris_auto_bmi2::attacks::timeLookups());
+	magicTime = std::min(magicTime, polaris_auto_avx2::attacks::timeLookups());
+
+	return bmi2Time < magicTime
+		? polaris_auto_bmi2::run(argc, argv)
+		: polaris_auto_avx2::run(argc, argv);
+}
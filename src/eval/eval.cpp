@@ -24,6 +24,8 @@
 #include "../pretty.h"
 #include "../attacks/attacks.h"
 #include "../rays.h"
+#include "../tunable.h"
+#include "nnue.h"
 
 namespace polaris::eval
 {
@@ -152,13 +154,32 @@ namespace polaris::eval
 		template <Color Us>
 		constexpr auto PawnHelperMasks = generatePawnHelperMasks<Us>();
 
+		// kept out of the evaluator, as neither the phase, the halfmove
+		// clock nor the tempo bonus are part of the key for the eval cache
+		inline auto scaleEval(const Position &pos, TaperedScore total)
+		{
+			auto eval = pos.interpScore(total);
+
+			eval = (eval * (200 - pos.halfmove())) / 200;
+
+			if (pos.isLikelyDrawn())
+				eval /= 8;
+
+			return eval;
+		}
+
 		class Evaluator
 		{
 		public:
 			explicit Evaluator(const Position &pos, PawnCache *pawnCache);
+			// stops early if the material, psts and pawn structure alone are outside the
+			// (side to move relative) window by the lazy eval margin tunable, leaving the other terms zeroed
+			Evaluator(const Position &pos, PawnCache *pawnCache, Score alpha, Score beta);
 			~Evaluator() = default;
 
 			[[nodiscard]] inline auto eval() const { return m_final; }
+			[[nodiscard]] inline auto total() const { return m_total; }
+			[[nodiscard]] inline auto lazyExit() const { return m_lazyExit; }
 			auto printEval() const -> void;
 
 		private:
@@ -171,6 +192,19 @@ namespace polaris::eval
 
 				Bitboard passers;
 
+				// with normal occupancy, filled in by the piece terms
+				// so that later terms do not have to repeat lookups
+				std::array<Bitboard, 6> attacksBy{};
+				Bitboard allAttacks{};
+				Bitboard doubleAttacks{};
+
+				inline auto addAttacks(BasePiece piece, Bitboard attacks)
+				{
+					attacksBy[static_cast<i32>(piece)] |= attacks;
+					doubleAttacks |= allAttacks & attacks;
+					allAttacks |= attacks;
+				}
+
 				TaperedScore pawnStructure{};
 
 				TaperedScore pawns{};
@@ -207,7 +241,11 @@ namespace polaris::eval
 			template <Color Us>
 			auto evalKingSafety      (const Position &pos, EvalData &ours, const EvalData &theirs) -> void;
 
+			auto evalCheap(PawnCache *pawnCache) -> void;
+			auto evalRest() -> void;
+
 			bool m_cachedPawnStructureEval{false};
+			bool m_lazyExit{false};
 
 			const Position &m_pos;
 
@@ -217,13 +255,41 @@ namespace polaris::eval
 			Bitboard m_openFiles{};
 
 			TaperedScore m_total{};
+
 			Score m_final;
 		};
 
 		Evaluator::Evaluator(const Position &pos, PawnCache *pawnCache)
 			: m_pos{pos}
 		{
-			const auto &boards = pos.boards();
+			evalCheap(pawnCache);
+			evalRest();
+		}
+
+		Evaluator::Evaluator(const Position &pos, PawnCache *pawnCache, Score alpha, Score beta)
+			: m_pos{pos}
+		{
+			evalCheap(pawnCache);
+
+			m_final = scaleEval(pos, m_total);
+
+			const auto partial = (pos.toMove() == Color::Black ? -m_final : m_final) + Tempo;
+
+			// the margin is the largest the non-material, non-pawn-structure terms can plausibly swing the eval
+			const auto margin = tunable::lazyEvalMargin();
+
+			if (partial - margin >= beta || partial + margin <= alpha)
+			{
+				m_lazyExit = true;
+				return;
+			}
+
+			evalRest();
+		}
+
+		auto Evaluator::evalCheap(PawnCache *pawnCache) -> void
+		{
+			const auto &boards = m_pos.boards();
 
 			const auto blackPawns = boards.blackPawns();
 			const auto whitePawns = boards.whitePawns();
@@ -233,11 +299,19 @@ namespace polaris::eval
 
 			m_blackData.pawnAttacks = blackPawnLeftAttacks | blackPawnRightAttacks;
 
+			m_blackData.attacksBy[static_cast<i32>(BasePiece::Pawn)] = m_blackData.pawnAttacks;
+			m_blackData.allAttacks = m_blackData.pawnAttacks;
+			m_blackData.doubleAttacks = blackPawnLeftAttacks & blackPawnRightAttacks;
+
 			const auto whitePawnLeftAttacks = whitePawns.shiftUpLeft();
 			const auto whitePawnRightAttacks = whitePawns.shiftUpRight();
 
 			m_whiteData.pawnAttacks = whitePawnLeftAttacks | whitePawnRightAttacks;
 
+			m_whiteData.attacksBy[static_cast<i32>(BasePiece::Pawn)] = m_whiteData.pawnAttacks;
+			m_whiteData.allAttacks = m_whiteData.pawnAttacks;
+			m_whiteData.doubleAttacks = whitePawnLeftAttacks & whitePawnRightAttacks;
+
 			m_blackData.semiOpen = ~blackPawns.fillFile();
 			m_whiteData.semiOpen = ~whitePawns.fillFile();
 
@@ -246,13 +320,13 @@ namespace polaris::eval
 
 			m_openFiles = m_blackData.semiOpen & m_whiteData.semiOpen;
 
-			m_total = pos.material();
+			m_total = m_pos.material();
 
 			if (pawnCache)
 			{
-				auto &cacheEntry = pawnCache->probe(pos.pawnKey());
+				PawnCacheEntry cacheEntry{};
 
-				if (cacheEntry.key == pos.pawnKey())
+				if (pawnCache->probe(m_pos.pawnKey(), cacheEntry))
 				{
 					m_whiteData.pawnStructure = cacheEntry.eval;
 
@@ -263,45 +337,47 @@ namespace polaris::eval
 				}
 				else
 				{
-					evalPawnStructure<Color::Black>(pos, m_blackData, m_whiteData);
-					evalPawnStructure<Color::White>(pos, m_whiteData, m_blackData);
+					evalPawnStructure<Color::Black>(m_pos, m_blackData, m_whiteData);
+					evalPawnStructure<Color::White>(m_pos, m_whiteData, m_blackData);
 
-					cacheEntry.key = pos.pawnKey();
-					cacheEntry.eval = m_whiteData.pawnStructure - m_blackData.pawnStructure;
-					cacheEntry.passers = m_blackData.passers | m_whiteData.passers;
+					pawnCache->put(m_pos.pawnKey(), m_whiteData.pawnStructure - m_blackData.pawnStructure,
+						m_blackData.passers | m_whiteData.passers);
 				}
 			}
 			else
 			{
-				evalPawnStructure<Color::Black>(pos, m_blackData, m_whiteData);
-				evalPawnStructure<Color::White>(pos, m_whiteData, m_blackData);
+				evalPawnStructure<Color::Black>(m_pos, m_blackData, m_whiteData);
+				evalPawnStructure<Color::White>(m_pos, m_whiteData, m_blackData);
 			}
 
-			evalPawns<Color::Black>(pos, m_blackData, m_whiteData);
-			evalPawns<Color::White>(pos, m_whiteData, m_blackData);
+			m_total += m_whiteData.pawnStructure - m_blackData.pawnStructure;
+		}
 
-			evalKnights<Color::Black>(pos, m_blackData, m_whiteData);
-			evalKnights<Color::White>(pos, m_whiteData, m_blackData);
+		auto Evaluator::evalRest() -> void
+		{
+			evalPawns<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalPawns<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalBishops<Color::Black>(pos, m_blackData, m_whiteData);
-			evalBishops<Color::White>(pos, m_whiteData, m_blackData);
+			evalKnights<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalKnights<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalRooks<Color::Black>(pos, m_blackData, m_whiteData);
-			evalRooks<Color::White>(pos, m_whiteData, m_blackData);
+			evalBishops<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalBishops<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalQueens<Color::Black>(pos, m_blackData, m_whiteData);
-			evalQueens<Color::White>(pos, m_whiteData, m_blackData);
+			evalRooks<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalRooks<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalKing<Color::Black>(pos, m_blackData, m_whiteData);
-			evalKing<Color::White>(pos, m_whiteData, m_blackData);
+			evalQueens<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalQueens<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalHangingAndPinned<Color::Black>(pos, m_blackData, m_whiteData);
-			evalHangingAndPinned<Color::White>(pos, m_whiteData, m_blackData);
+			evalKing<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalKing<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			evalKingSafety<Color::Black>(pos, m_blackData, m_whiteData);
-			evalKingSafety<Color::White>(pos, m_whiteData, m_blackData);
+			evalHangingAndPinned<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalHangingAndPinned<Color::White>(m_pos, m_whiteData, m_blackData);
 
-			m_total += m_whiteData.pawnStructure - m_blackData.pawnStructure;
+			evalKingSafety<Color::Black>(m_pos, m_blackData, m_whiteData);
+			evalKingSafety<Color::White>(m_pos, m_whiteData, m_blackData);
 
 			m_total += m_whiteData.pawns         - m_blackData.pawns;
 			m_total += m_whiteData.knights       - m_blackData.knights;
@@ -317,12 +393,7 @@ namespace polaris::eval
 
 			m_total += m_whiteData.kingSafety    - m_blackData.kingSafety;
 
-			m_final = pos.interpScore(m_total);
-
-			m_final = (m_final * (200 - pos.halfmove())) / 200;
-
-			if (pos.isLikelyDrawn())
-				m_final /= 8;
+			m_final = scaleEval(m_pos, m_total);
 		}
 
 		auto Evaluator::printEval() const -> void
@@ -536,6 +607,7 @@ namespace polaris::eval
 					ours.knights += KnightOutpost;
 
 				const auto attacks = attacks::getKnightAttacks(square);
+				ours.addAttacks(BasePiece::Knight, attacks);
 
 				ours.knights += MinorAttackingRook  * (attacks & boards.template  rooks<Them>()).popcount();
 				ours.knights += MinorAttackingQueen * (attacks & boards.template queens<Them>()).popcount();
@@ -571,6 +643,7 @@ namespace polaris::eval
 				const auto square = bishops.popLowestSquare();
 
 				const auto attacks = attacks::getBishopAttacks(square, occupancy);
+				ours.addAttacks(BasePiece::Bishop, attacks);
 
 				ours.bishops += MinorAttackingRook  * (attacks & boards.template  rooks<Them>()).popcount();
 				ours.bishops += MinorAttackingQueen * (attacks & boards.template queens<Them>()).popcount();
@@ -609,6 +682,7 @@ namespace polaris::eval
 					ours.rooks += RookSupportingPasser;
 
 				const auto attacks = attacks::getRookAttacks(square, occupancy);
+				ours.addAttacks(BasePiece::Rook, attacks);
 
 				ours.rooks += RookAttackingQueen * (attacks & boards.template queens<Them>()).popcount();
 
@@ -635,6 +709,8 @@ namespace polaris::eval
 			{
 				const auto square = queens.popLowestSquare();
 
+				ours.addAttacks(BasePiece::Queen, attacks::getQueenAttacks(square, occupancy));
+
 				const auto mobilityAttacks = attacks::getQueenAttacks(square, xrayOcc);
 				ours.mobility += QueenMobility[(mobilityAttacks & ours.available).popcount()];
 			}
@@ -647,12 +723,16 @@ namespace polaris::eval
 
 			const auto king = boards.template kings<Us>();
 
+			ours.addAttacks(BasePiece::King, attacks::getKingAttacks(pos.template king<Us>()));
+
 			if (!(king & m_openFiles).empty())
 				ours.kings += KingOnOpenFile;
 			else if (!(king & ours.semiOpen).empty())
 				ours.kings += KingOnSemiOpenFile;
 		}
 
+		// both sides' attack maps are complete by the time these run
+
 		template <Color Us>
 		auto Evaluator::evalHangingAndPinned(const Position &pos, EvalData &ours, const EvalData &theirs) -> void
 		{
@@ -666,13 +746,60 @@ namespace polaris::eval
 		}
 	}
 
-	auto staticEval(const Position &pos, PawnCache *pawnCache) -> Score
+	auto staticEval(const Position &pos, PawnCache *pawnCache, EvalCache *evalCache) -> Score
 	{
-		return Evaluator{pos, pawnCache}.eval() * (pos.toMove() == Color::Black ? -1 : 1) + Tempo;
+		if (pos.nnueEnabled())
+		{
+			// the network is side-to-move relative, so no tempo bonus
+			const auto eval = nnue::evaluate(pos.accumulator(), pos.toMove());
+			return (eval * (200 - pos.halfmove())) / 200;
+		}
+
+		TaperedScore total{};
+
+		if (!evalCache || !evalCache->probe(pos.key(), total))
+		{
+			total = Evaluator{pos, pawnCache}.total();
+
+			if (evalCache)
+				evalCache->put(pos.key(), total);
+		}
+
+		return scaleEval(pos, total) * (pos.toMove() == Color::Black ? -1 : 1) + Tempo;
+	}
+
+	auto staticEvalLazy(const Position &pos, Score alpha, Score beta,
+		PawnCache *pawnCache, EvalCache *evalCache) -> Score
+	{
+		if (pos.nnueEnabled())
+			return staticEval(pos);
+
+		TaperedScore total{};
+
+		if (!evalCache || !evalCache->probe(pos.key(), total))
+		{
+			const Evaluator evaluator{pos, pawnCache, alpha, beta};
+			total = evaluator.total();
+
+			// partial evals must never be cached
+			if (evalCache && !evaluator.lazyExit())
+				evalCache->put(pos.key(), total);
+		}
+
+		return scaleEval(pos, total) * (pos.toMove() == Color::Black ? -1 : 1) + Tempo;
 	}
 
 	auto printEval(const Position &pos, PawnCache *pawnCache) -> void
 	{
 		Evaluator{pos, pawnCache}.printEval();
+
+		if (pos.nnueEnabled())
+		{
+			const auto nnueEval = staticEval(pos);
+
+			std::cout << "\nNNUE eval: ";
+			printScore(std::cout, pos.toMove() == Color::Black ? -nnueEval : nnueEval);
+			std::cout << std::endl;
+		}
 	}
 }
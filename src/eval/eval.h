@@ -22,15 +22,19 @@
 
 #include <vector>
 #include <cstring>
+#include <bit>
 
 #include "../core.h"
 #include "../position/position.h"
+#include "../util/range.h"
 
 namespace polaris::eval
 {
 	constexpr Score Tempo = 16;
 
-	constexpr usize PawnCacheEntries = 262144;
+	// in MB, 262144 entries
+	constexpr usize DefaultPawnCacheSize = 6;
+	constexpr util::Range<usize> PawnCacheSizeRange{1, 1024};
 
 	struct PawnCacheEntry
 	{
@@ -39,35 +43,156 @@ namespace polaris::eval
 		Bitboard passers{};
 	};
 
-	static_assert(util::resetLsb(PawnCacheEntries) == 0); // power of 2
-	static_assert(sizeof(PawnCacheEntry) == 24);
-
+	// lockless so that it can be shared between search threads - keys are
+	// stored xored with the data they guard, so a torn write fails to verify
 	class PawnCache
 	{
 	public:
-		PawnCache()
+		explicit PawnCache(usize size = DefaultPawnCacheSize)
 		{
-			m_cache.resize(PawnCacheEntries);
+			resize(size);
 		}
 
 		~PawnCache() = default;
 
-		inline auto probe(u64 key) -> PawnCacheEntry &
+		// 0 frees the cache, which then misses every probe
+		inline auto resize(usize size) -> void
+		{
+			size *= 1024 * 1024;
+
+			const usize capacity = std::bit_floor(size / sizeof(Slot));
+
+			m_cache.resize(capacity);
+			m_cache.shrink_to_fit();
+
+			m_mask = capacity == 0 ? 0 : capacity - 1;
+
+			clear();
+		}
+
+		inline auto probe(u64 key, PawnCacheEntry &dst) const -> bool
+		{
+			if (m_cache.empty())
+				return false;
+
+			const auto &slot = m_cache[key & m_mask];
+
+			const auto check = __atomic_load_n(&slot.check, __ATOMIC_RELAXED);
+			const auto passers = __atomic_load_n(&slot.passers, __ATOMIC_RELAXED);
+			const auto eval = __atomic_load_n(&slot.eval, __ATOMIC_RELAXED);
+
+			if ((check ^ passers ^ eval) != key)
+				return false;
+
+			dst.key = key;
+			dst.eval = std::bit_cast<TaperedScore>(static_cast<u32>(eval));
+			dst.passers = passers;
+
+			return true;
+		}
+
+		inline auto put(u64 key, TaperedScore eval, Bitboard passers) -> void
+		{
+			if (m_cache.empty())
+				return;
+
+			auto &slot = m_cache[key & m_mask];
+
+			const u64 evalBits = std::bit_cast<u32>(eval);
+
+			__atomic_store_n(&slot.check, key ^ passers ^ evalBits, __ATOMIC_RELAXED);
+			__atomic_store_n(&slot.passers, static_cast<u64>(passers), __ATOMIC_RELAXED);
+			__atomic_store_n(&slot.eval, evalBits, __ATOMIC_RELAXED);
+		}
+
+		inline auto clear() -> void
+		{
+			std::memset(m_cache.data(), 0, m_cache.size() * sizeof(Slot));
+		}
+
+	private:
+		struct Slot
+		{
+			u64 check;
+			u64 passers;
+			u64 eval;
+		};
+
+		static_assert(sizeof(Slot) == 24);
+
+		u64 m_mask{};
+		std::vector<Slot> m_cache{};
+	};
+
+	constexpr usize EvalCacheEntries = 65536;
+
+	struct EvalCacheEntry
+	{
+		u64 key{};
+		// white-relative, before phase interpolation - the phase is not
+		// a pure function of the position (it is clamped incrementally)
+		TaperedScore eval{};
+	};
+
+	static_assert(util::resetLsb(EvalCacheEntries) == 0); // power of 2
+	static_assert(sizeof(EvalCacheEntry) == 16);
+
+	class EvalCache
+	{
+	public:
+		EvalCache()
+		{
+			m_cache.resize(EvalCacheEntries);
+		}
+
+		~EvalCache() = default;
+
+		inline auto probe(u64 key, TaperedScore &eval) -> bool
+		{
+			++m_probes;
+
+			const auto &entry = m_cache[key & EvalCacheMask];
+
+			if (entry.key != key)
+				return false;
+
+			++m_hits;
+			eval = entry.eval;
+
+			return true;
+		}
+
+		inline auto put(u64 key, TaperedScore eval)
 		{
-			constexpr usize PawnCacheMask = PawnCacheEntries - 1;
-			return m_cache[key & PawnCacheMask];
+			m_cache[key & EvalCacheMask] = {key, eval};
 		}
 
 		inline auto clear()
 		{
-			std::memset(m_cache.data(), 0, m_cache.size() * sizeof(PawnCacheEntry));
+			std::memset(m_cache.data(), 0, m_cache.size() * sizeof(EvalCacheEntry));
+
+			m_probes = 0;
+			m_hits = 0;
 		}
 
+		[[nodiscard]] inline auto probes() const { return m_probes; }
+		[[nodiscard]] inline auto hits() const { return m_hits; }
+
 	private:
-		std::vector<PawnCacheEntry> m_cache{};
+		static constexpr usize EvalCacheMask = EvalCacheEntries - 1;
+
+		std::vector<EvalCacheEntry> m_cache{};
+
+		usize m_probes{};
+		usize m_hits{};
 	};
 
-	auto staticEval(const Position &pos, PawnCache *pawnCache = nullptr) -> Score;
+	auto staticEval(const Position &pos, PawnCache *pawnCache = nullptr, EvalCache *evalCache = nullptr) -> Score;
+
+	// side to move relative window - outside it by a wide enough margin,
+	// only material, psts and pawn structure are evaluated
+	auto staticEvalLazy(const Position &pos, Score alpha, Score beta,
+		PawnCache *pawnCache = nullptr, EvalCache *evalCache = nullptr) -> Score;
 
 	inline auto staticEvalAbs(const Position &pos, PawnCache *pawnCache = nullptr)
 	{
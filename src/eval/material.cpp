@@ -88,7 +88,7 @@ namespace polaris::eval
 				}
 			};
 
-			auto createPsts() -> std::array<std::array<TaperedScore, 64>, 12>
+			consteval auto createPsts() -> std::array<std::array<TaperedScore, 64>, 12>
 			{
 				std::array<std::array<TaperedScore, 64>, 12> psts{};
 
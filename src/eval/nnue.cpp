@@ -0,0 +1,240 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "nnue.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX512BW__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef PS_NETWORK_FILE
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#error embedding a network requires GCC or Clang
+	#endif
+
+	#if defined(__APPLE__)
+		#define PS_NETWORK_SECTION "__DATA,__const"
+		#define PS_NETWORK_SYMBOL(Name) "_" #Name
+	#elif defined(_WIN32)
+		#define PS_NETWORK_SECTION ".rdata"
+		#define PS_NETWORK_SYMBOL(Name) #Name
+	#else
+		#define PS_NETWORK_SECTION ".rodata"
+		#define PS_NETWORK_SYMBOL(Name) #Name
+	#endif
+
+asm(
+	".pushsection " PS_NETWORK_SECTION "\n"
+	".balign 64\n"
+	".globl " PS_NETWORK_SYMBOL(polarisEmbeddedNetwork) "\n"
+	PS_NETWORK_SYMBOL(polarisEmbeddedNetwork) ":\n"
+	".incbin \"" PS_NETWORK_FILE "\"\n"
+	".globl " PS_NETWORK_SYMBOL(polarisEmbeddedNetworkEnd) "\n"
+	PS_NETWORK_SYMBOL(polarisEmbeddedNetworkEnd) ":\n"
+	".popsection\n"
+);
+
+extern "C" const polaris::u8 polarisEmbeddedNetwork[];
+extern "C" const polaris::u8 polarisEmbeddedNetworkEnd[];
+#endif
+
+namespace polaris::eval::nnue
+{
+	namespace
+	{
+		Network s_network{};
+		bool s_loaded{false};
+
+		// assumes a little-endian host, like the rest of the engine
+		auto loadFromMemory(const u8 *data, usize size)
+		{
+			if (size != NetworkFileSize)
+				return false;
+
+			const auto read = [&data](auto &dst, usize bytes)
+			{
+				std::memcpy(&dst, data, bytes);
+				data += bytes;
+			};
+
+			read(s_network.featureWeights, sizeof(s_network.featureWeights));
+			read(s_network.featureBiases, sizeof(s_network.featureBiases));
+			read(s_network.outputWeights, sizeof(s_network.outputWeights));
+			read(s_network.outputBias, sizeof(s_network.outputBias));
+
+			return true;
+		}
+
+		// sum of screlu(input) * weight, with screlu(x) = clamp(x, 0, L1Q)^2
+		// (v * w) * v rather than (v * v) * w keeps the product in 16 bits for madd
+		inline auto screluDot(const std::array<i16, Layer1Size> &inputs, const i16 *weights) -> i32
+		{
+#if defined(__AVX512BW__)
+			static_assert(Layer1Size % 32 == 0);
+
+			const auto zero = _mm512_setzero_si512();
+			const auto max = _mm512_set1_epi16(static_cast<i16>(L1Q));
+
+			auto sum = _mm512_setzero_si512();
+
+			for (u32 i = 0; i < Layer1Size; i += 32)
+			{
+				auto v = _mm512_load_si512(&inputs[i]);
+				v = _mm512_min_epi16(_mm512_max_epi16(v, zero), max);
+
+				const auto w = _mm512_load_si512(&weights[i]);
+				const auto product = _mm512_madd_epi16(_mm512_mullo_epi16(v, w), v);
+
+				sum = _mm512_add_epi32(sum, product);
+			}
+
+			return _mm512_reduce_add_epi32(sum);
+#elif defined(__AVX2__)
+			static_assert(Layer1Size % 16 == 0);
+
+			const auto zero = _mm256_setzero_si256();
+			const auto max = _mm256_set1_epi16(static_cast<i16>(L1Q));
+
+			auto sum = _mm256_setzero_si256();
+
+			for (u32 i = 0; i < Layer1Size; i += 16)
+			{
+				auto v = _mm256_load_si256(reinterpret_cast<const __m256i *>(&inputs[i]));
+				v = _mm256_min_epi16(_mm256_max_epi16(v, zero), max);
+
+				const auto w = _mm256_load_si256(reinterpret_cast<const __m256i *>(&weights[i]));
+				const auto product = _mm256_madd_epi16(_mm256_mullo_epi16(v, w), v);
+
+				sum = _mm256_add_epi32(sum, product);
+			}
+
+			auto sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+			sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+			sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			return _mm_cvtsi128_si32(sum128);
+#elif defined(__SSE2__)
+			static_assert(Layer1Size % 8 == 0);
+
+			const auto zero = _mm_setzero_si128();
+			const auto max = _mm_set1_epi16(static_cast<i16>(L1Q));
+
+			auto sum = _mm_setzero_si128();
+
+			for (u32 i = 0; i < Layer1Size; i += 8)
+			{
+				auto v = _mm_load_si128(reinterpret_cast<const __m128i *>(&inputs[i]));
+				v = _mm_min_epi16(_mm_max_epi16(v, zero), max);
+
+				const auto w = _mm_load_si128(reinterpret_cast<const __m128i *>(&weights[i]));
+				const auto product = _mm_madd_epi16(_mm_mullo_epi16(v, w), v);
+
+				sum = _mm_add_epi32(sum, product);
+			}
+
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			return _mm_cvtsi128_si32(sum);
+#else
+			i32 sum = 0;
+
+			for (u32 i = 0; i < Layer1Size; ++i)
+			{
+				const i32 v = std::clamp(static_cast<i32>(inputs[i]), 0, L1Q);
+				sum += v * v * static_cast<i32>(weights[i]);
+			}
+
+			return sum;
+#endif
+		}
+	}
+
+	const Network &g_network = s_network;
+
+	auto init() -> void
+	{
+#ifdef PS_NETWORK_FILE
+		const auto size = static_cast<usize>(polarisEmbeddedNetworkEnd - polarisEmbeddedNetwork);
+
+		if (!(s_loaded = loadFromMemory(polarisEmbeddedNetwork, size)))
+			std::cerr << "embedded network is " << size << " bytes, expected " << NetworkFileSize << std::endl;
+#endif
+	}
+
+	auto loadNetwork(const std::string &path) -> bool
+	{
+		std::ifstream stream{path, std::ios::binary | std::ios::ate};
+
+		if (!stream)
+			return false;
+
+		const auto size = static_cast<usize>(stream.tellg());
+
+		if (size != NetworkFileSize)
+			return false;
+
+		std::vector<u8> data(size);
+
+		stream.seekg(0);
+		if (!stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(size)))
+			return false;
+
+		s_loaded = loadFromMemory(data.data(), data.size());
+		return s_loaded;
+	}
+
+	auto networkLoaded() -> bool
+	{
+		return s_loaded;
+	}
+
+	auto Accumulator::refresh(const PositionBoards &boards) -> void
+	{
+		values[0] = g_network.featureBiases;
+		values[1] = g_network.featureBiases;
+
+		auto occ = boards.occupancy();
+		while (occ)
+		{
+			const auto square = occ.popLowestSquare();
+			activate(boards.pieceAt(square), square);
+		}
+	}
+
+	auto evaluate(const Accumulator &accumulator, Color toMove) -> Score
+	{
+		auto sum = screluDot(accumulator.forColor(toMove), &g_network.outputWeights[0])
+			+ screluDot(accumulator.forColor(oppColor(toMove)), &g_network.outputWeights[Layer1Size]);
+
+		// screlu output is squared, so one factor of L1Q has to come out first
+		sum /= L1Q;
+		sum += g_network.outputBias;
+
+		const auto eval = static_cast<Score>(sum * Scale / (L1Q * OutputQ));
+
+		// keep the network out of the win range, or search reads it as a tb or mate score
+		return std::clamp(eval, -ScoreWin + 1, ScoreWin - 1);
+	}
+}
@@ -0,0 +1,140 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <array>
+#include <string>
+
+#include "../core.h"
+#include "../position/boards.h"
+
+// (768 -> 256)x2 -> 1, perspective, SCReLU
+// the network is stored as little-endian i16s, in the order
+// feature weights, feature biases, output weights, output bias
+namespace polaris::eval::nnue
+{
+	constexpr u32 InputSize = 768;
+	constexpr u32 Layer1Size = 256;
+
+	// feature weights and biases are quantised by L1Q, output weights by OutputQ
+	// SCReLU inference relies on the output weights staying within [-128, 128]
+	constexpr i32 L1Q = 255;
+	constexpr i32 OutputQ = 64;
+	constexpr i32 Scale = 400;
+
+	struct alignas(64) Network
+	{
+		std::array<i16, InputSize * Layer1Size> featureWeights;
+		std::array<i16, Layer1Size> featureBiases;
+		std::array<i16, Layer1Size * 2> outputWeights;
+		i16 outputBias;
+	};
+
+	constexpr usize NetworkFileSize = (InputSize * Layer1Size + Layer1Size + Layer1Size * 2 + 1) * sizeof(i16);
+
+	extern const Network &g_network;
+
+	// the embedded network if one was built in, otherwise zeroed
+	auto init() -> void;
+
+	// false if the file is missing or not a network of this architecture
+	auto loadNetwork(const std::string &path) -> bool;
+
+	[[nodiscard]] auto networkLoaded() -> bool;
+
+	[[nodiscard]] inline auto featureIndex(Color perspective, Piece piece, Square square)
+	{
+		const u32 colorOffset = pieceColor(piece) == perspective ? 0 : 384;
+		const auto pieceOffset = static_cast<u32>(basePiece(piece)) * 64;
+		// black sees the board flipped vertically
+		const auto squareIdx = perspective == Color::Black
+			? static_cast<u32>(square) ^ 0x38 : static_cast<u32>(square);
+
+		return colorOffset + pieceOffset + squareIdx;
+	}
+
+	// these loops are plain on purpose - at -O3 they are vectorised
+	// to the widest registers the build target has
+	struct alignas(64) Accumulator
+	{
+		std::array<std::array<i16, Layer1Size>, 2> values;
+
+		[[nodiscard]] inline auto forColor(Color c) const -> const auto &
+		{
+			return values[static_cast<i32>(c)];
+		}
+
+		inline auto activate(Piece piece, Square square) -> void
+		{
+			for (const auto c : {Color::Black, Color::White})
+			{
+				auto &acc = values[static_cast<i32>(c)];
+				const auto *weights = &g_network.featureWeights[featureIndex(c, piece, square) * Layer1Size];
+
+				for (u32 i = 0; i < Layer1Size; ++i)
+				{
+					acc[i] += weights[i];
+				}
+			}
+		}
+
+		inline auto deactivate(Piece piece, Square square) -> void
+		{
+			for (const auto c : {Color::Black, Color::White})
+			{
+				auto &acc = values[static_cast<i32>(c)];
+				const auto *weights = &g_network.featureWeights[featureIndex(c, piece, square) * Layer1Size];
+
+				for (u32 i = 0; i < Layer1Size; ++i)
+				{
+					acc[i] -= weights[i];
+				}
+			}
+		}
+
+		inline auto move(Piece piece, Square src, Square dst) -> void
+		{
+			moveAndChange(piece, src, piece, dst);
+		}
+
+		// one pass instead of a separate deactivate and activate
+		inline auto moveAndChange(Piece srcPiece, Square src, Piece dstPiece, Square dst) -> void
+		{
+			for (const auto c : {Color::Black, Color::White})
+			{
+				auto &acc = values[static_cast<i32>(c)];
+
+				const auto *subWeights = &g_network.featureWeights[featureIndex(c, srcPiece, src) * Layer1Size];
+				const auto *addWeights = &g_network.featureWeights[featureIndex(c, dstPiece, dst) * Layer1Size];
+
+				for (u32 i = 0; i < Layer1Size; ++i)
+				{
+					acc[i] += addWeights[i] - subWeights[i];
+				}
+			}
+		}
+
+		auto refresh(const PositionBoards &boards) -> void;
+	};
+
+	// side to move relative
+	[[nodiscard]] auto evaluate(const Accumulator &accumulator, Color toMove) -> Score;
+}
@@ -23,6 +23,9 @@
 #include <array>
 #include <utility>
 #include <cstring>
+#include <algorithm>
+#include <limits>
+#include <span>
 
 #include "core.h"
 #include "move.h"
@@ -30,10 +33,27 @@
 
 namespace polaris
 {
-	inline auto updateHistoryScore(i32 &score, i32 adjustment)
+	using HistoryScore = i16;
+
+	// scores are pulled back towards zero in proportion to the adjustment, which
+	// bounds them at HistoryScale * HistoryGravity as long as the adjustment itself
+	// stays within HistoryGravity. that bound has to fit in a HistoryScore
+	constexpr i32 HistoryGravity = 324;
+	constexpr i32 HistoryScale = 32;
+
+	constexpr i32 MaxHistory = HistoryGravity * HistoryScale;
+	static_assert(MaxHistory <= std::numeric_limits<HistoryScore>::max());
+
+	inline auto updateHistoryScore(HistoryScore &score, i32 adjustment)
 	{
-		score -= (score * std::abs(adjustment)) / 324;
-		score += adjustment * 32;
+		adjustment = std::clamp(adjustment, -HistoryGravity, HistoryGravity);
+
+		i32 newScore = score;
+
+		newScore -= (newScore * std::abs(adjustment)) / HistoryGravity;
+		newScore += adjustment * HistoryScale;
+
+		score = static_cast<HistoryScore>(std::clamp(newScore, -MaxHistory, MaxHistory));
 	}
 
 	struct HistoryMove
@@ -57,12 +77,6 @@ namespace polaris
 		}
 	};
 
-	struct HistoryEntry
-	{
-		i32 score{};
-		Move countermove{NullMove};
-	};
-
 	class ContinuationEntry
 	{
 	public:
@@ -80,27 +94,45 @@ namespace polaris
 		}
 
 	private:
-		using Table = std::array<std::array<i32, 64>, 12>;
+		using Table = std::array<std::array<HistoryScore, 64>, 12>;
 
 		Table m_table{};
 	};
 
+	// continuation history is indexed by the moves made this many plies before the current one.
+	// the first FullWeightContinuations count fully when ordering quiets, the older ones half
+	constexpr auto ContinuationPlies = std::array{1, 2, 4, 6};
+	constexpr usize FullWeightContinuations = 2;
+
+	// null where there was no move that many plies back (root, or a null move)
+	using ContinuationEntries = std::array<ContinuationEntry *, ContinuationPlies.size()>;
+
 	class HistoryTable
 	{
 	public:
 		HistoryTable() = default;
 		~HistoryTable() = default;
 
-		[[nodiscard]] inline auto entry(HistoryMove move) -> auto &
+		[[nodiscard]] inline auto score(HistoryMove move) -> auto &
 		{
 			return m_table[static_cast<i32>(move.moving)][static_cast<i32>(move.dst)];
 		}
 
-		[[nodiscard]] inline auto entry(HistoryMove move) const -> const auto &
+		[[nodiscard]] inline auto score(HistoryMove move) const
 		{
 			return m_table[static_cast<i32>(move.moving)][static_cast<i32>(move.dst)];
 		}
 
+		[[nodiscard]] inline auto countermove(HistoryMove move) -> auto &
+		{
+			return m_countermoveTable[static_cast<i32>(move.moving)][static_cast<i32>(move.dst)];
+		}
+
+		[[nodiscard]] inline auto countermove(HistoryMove move) const
+		{
+			return m_countermoveTable[static_cast<i32>(move.moving)][static_cast<i32>(move.dst)];
+		}
+
 		[[nodiscard]] inline auto captureScore(HistoryMove move, Piece captured) -> auto &
 		{
 			return m_captureTable[static_cast<i32>(captured)]
@@ -123,31 +155,62 @@ namespace polaris
 			return m_continuationTable[static_cast<i32>(move.moving)][static_cast<i32>(move.dst)];
 		}
 
+		// bonus for the quiet move that caused a cutoff, malus for the quiets tried before it.
+		// tried moves can share a (piece, dst) slot, so each table is a plain loop over them
+		inline auto updateQuiet(const ContinuationEntries &conts, HistoryMove best,
+			std::span<const HistoryMove> tried, i32 adjustment) -> void
+		{
+			updateHistoryScore(score(best), adjustment);
+
+			for (const auto move : tried)
+			{
+				updateHistoryScore(score(move), -adjustment);
+			}
+
+			for (auto *cont : conts)
+			{
+				if (!cont)
+					continue;
+
+				updateHistoryScore(cont->score(best), adjustment);
+
+				for (const auto move : tried)
+				{
+					updateHistoryScore(cont->score(move), -adjustment);
+				}
+			}
+		}
+
+		// scores are kept apart from the countermoves so this is a
+		// contiguous run of i16s, which is vectorised at -O3
 		inline auto age()
 		{
 			for (auto &pieceTable : m_table)
 			{
-				for (auto &dstSquare : pieceTable)
+				for (auto &score : pieceTable)
 				{
-					dstSquare.score /= 2;
+					score /= 2;
 				}
 			}
 		}
 
 		inline auto clear()
 		{
-			std::memset(m_table.data(), 0, sizeof(HistoryEntry) * 64 * 12);
-			std::memset(m_captureTable.data(), 0, sizeof(i32) * 64 * 12 * 13);
-			std::memset(m_continuationTable.data(), 0, sizeof(i32) * 64 * 12 * 64 * 12);
+			std::memset(m_table.data(), 0, sizeof(Table));
+			std::memset(m_countermoveTable.data(), 0, sizeof(CountermoveTable));
+			std::memset(m_captureTable.data(), 0, sizeof(CaptureTable));
+			std::memset(m_continuationTable.data(), 0, sizeof(ContinuationTable));
 		}
 
 	private:
-		using Table = std::array<std::array<HistoryEntry, 64>, 12>;
+		using Table = std::array<std::array<HistoryScore, 64>, 12>;
+		using CountermoveTable = std::array<std::array<Move, 64>, 12>;
 		// 13 to account for non-capture queen promos
-		using CaptureTable = std::array<std::array<std::array<i32, 64>, 12>, 13>;
+		using CaptureTable = std::array<std::array<std::array<HistoryScore, 64>, 12>, 13>;
 		using ContinuationTable = std::array<std::array<ContinuationEntry, 64>, 12>;
 
 		Table m_table{};
+		CountermoveTable m_countermoveTable{};
 		CaptureTable m_captureTable{};
 		ContinuationTable m_continuationTable{};
 	};
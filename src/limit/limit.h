@@ -24,12 +24,19 @@
 
 namespace polaris::limit
 {
+	// nodes searched by the main thread between calls to stop(), for limiters that don't adapt it
+	constexpr usize DefaultCheckInterval = 1024;
+
 	class ISearchLimiter
 	{
 	public:
 		virtual ~ISearchLimiter() = default;
 
-		virtual auto update(const search::SearchData &data, Move bestMove, usize totalNodes) -> void {}
+		// called by the main thread after each call to stop(), nodes to search before the next one
+		[[nodiscard]] virtual auto checkInterval(const search::SearchData &data) const -> usize { return DefaultCheckInterval; }
+
+		// called by the main thread after each iteration
+		virtual auto update(const search::SearchData &data, Score score, Move bestMove, usize totalNodes) -> void {}
 		virtual auto updateMoveNodes(Move move, usize nodes) -> void {}
 
 		[[nodiscard]] virtual auto stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool = 0;
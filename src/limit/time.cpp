@@ -19,22 +19,75 @@
 #include "time.h"
 
 #include <algorithm>
+#include <cmath>
+
+#include "../tunable.h"
 
 namespace polaris::limit
 {
+	auto OverheadTracker::addSample(f64 latency) -> void
+	{
+		m_samples[m_total % MaxSamples] = latency;
+		++m_total;
+	}
+
+	auto OverheadTracker::percentile() const -> f64
+	{
+		const auto count = sampleCount();
+
+		if (count == 0)
+			return 0.0;
+
+		auto sorted = m_samples;
+		const auto idx = (count * 95 - 1) / 100;
+
+		std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(idx),
+			sorted.begin() + static_cast<std::ptrdiff_t>(count));
+
+		return sorted[idx];
+	}
+
+	auto OverheadTracker::overhead() const -> std::optional<i32>
+	{
+		if (sampleCount() < MinSamples)
+			return {};
+
+		const auto overhead = static_cast<i32>(std::ceil(percentile() * 2.0 * 1000.0)) + 1;
+		return MoveOverheadRange.clamp(overhead);
+	}
+
+	auto adaptiveCheckInterval(usize nodes, f64 elapsed, f64 timeLeft) -> usize
+	{
+		// nothing to go by yet
+		if (nodes == 0 || elapsed <= 0.0)
+			return CheckIntervalRange.min();
+
+		const auto nps = static_cast<f64>(nodes) / elapsed;
+		const auto period = std::min(CheckPeriod, std::max(timeLeft, 0.0) / 4.0);
+
+		return CheckIntervalRange.clamp(static_cast<usize>(nps * period));
+	}
+
 	MoveTimeLimiter::MoveTimeLimiter(i64 time, i64 overhead)
-		: m_maxTime{util::g_timer.time() + static_cast<f64>(std::max(I64(1), time - overhead)) / 1000.0} {}
+		: m_startTime{util::g_timer.time()},
+		  m_maxTime{m_startTime + static_cast<f64>(std::max(I64(1), time - overhead)) / 1000.0} {}
+
+	auto MoveTimeLimiter::checkInterval(const search::SearchData &data) const -> usize
+	{
+		const auto now = util::g_timer.time();
+		return adaptiveCheckInterval(data.nodes, now - m_startTime, m_maxTime - now);
+	}
 
 	auto MoveTimeLimiter::stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool
 	{
 		return data.depth > 2
 			&& data.nodes > 0
-			&& (data.nodes % 1024) == 0
 			&& util::g_timer.time() >= m_maxTime;
 	}
 
-	TimeManager::TimeManager(f64 start, f64 remaining, f64 increment, i32 toGo, f64 overhead)
-		: m_startTime{start}
+	TimeManager::TimeManager(f64 start, f64 remaining, f64 increment, i32 toGo, f64 overhead, i64 nodesTime)
+		: m_startTime{start},
+		  m_nodesTime{nodesTime}
 	{
 		const auto limit = std::max(0.001, remaining - overhead);
 
@@ -47,13 +100,38 @@ namespace polaris::limit
 		m_softTime = std::min(baseTime * 0.6, m_maxTime);
 	}
 
-	auto TimeManager::update(const search::SearchData &data, Move bestMove, usize totalNodes) -> void
+	auto TimeManager::update(const search::SearchData &data, Score score, Move bestMove, usize totalNodes) -> void
 	{
+		using namespace tunable;
+
 		const auto bestMoveFraction = static_cast<f64>(m_moveNodeCounts[bestMove.srcIdx()][bestMove.dstIdx()])
 			/ static_cast<f64>(totalNodes);
-		const auto moveNodeScale = (1.5 - bestMoveFraction) * 1.35;
+		const auto moveNodeScale = (static_cast<f64>(tmNodeFractionBase()) / 100.0 - bestMoveFraction)
+			* static_cast<f64>(tmNodeFractionScale()) / 100.0;
+
+		// spend less time while the best move stays the same
+		if (bestMove == m_prevBestMove)
+			m_stability = std::min(m_stability + 1, tmMaxStability());
+		else m_stability = 0;
+
+		m_prevBestMove = bestMove;
+
+		const auto stabilityScale = static_cast<f64>(tmStabilityBase() - tmStabilityStep() * m_stability) / 100.0;
 
-		m_scale = moveNodeScale;
+		// and more when the score drops
+		f64 scoreScale = 1.0;
+
+		if (m_hasPrevScore)
+		{
+			const auto scoreDelta = static_cast<f64>(m_prevScore - score);
+			scoreScale = std::clamp(1.0 + scoreDelta * static_cast<f64>(tmScoreDeltaScale()) / 1000.0,
+				static_cast<f64>(tmMinScoreScale()) / 100.0, static_cast<f64>(tmMaxScoreScale()) / 100.0);
+		}
+
+		m_prevScore = score;
+		m_hasPrevScore = true;
+
+		m_scale = moveNodeScale * stabilityScale * scoreScale;
 	}
 
 	auto TimeManager::updateMoveNodes(Move move, usize nodes) -> void
@@ -61,14 +139,26 @@ namespace polaris::limit
 		m_moveNodeCounts[move.srcIdx()][move.dstIdx()] += nodes;
 	}
 
+	// with nodes time, elapsed is derived from nodes alone, so the checks stay deterministic
+	auto TimeManager::checkInterval(const search::SearchData &data) const -> usize
+	{
+		const auto time = elapsed(data);
+		return adaptiveCheckInterval(data.nodes, time, m_maxTime - time);
+	}
+
 	auto TimeManager::stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool
 	{
-		if (data.depth < 5
-			|| data.nodes == 0
-			|| (!allowSoftTimeout && (data.nodes % 1024) != 0))
+		if (data.depth < 5 || data.nodes == 0)
 			return false;
 
-		const auto elapsed = util::g_timer.time() - m_startTime;
-		return elapsed > m_maxTime || (allowSoftTimeout && elapsed > m_softTime * m_scale);
+		const auto time = elapsed(data);
+		return time > m_maxTime || (allowSoftTimeout && time > m_softTime * m_scale);
+	}
+
+	auto TimeManager::elapsed(const search::SearchData &data) const -> f64
+	{
+		return m_nodesTime > 0
+			? static_cast<f64>(data.nodes) / static_cast<f64>(m_nodesTime) / 1000.0
+			: util::g_timer.time() - m_startTime;
 	}
 }
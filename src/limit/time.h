@@ -21,6 +21,8 @@
 #include "../types.h"
 
 #include <array>
+#include <optional>
+#include <algorithm>
 
 #include "limit.h"
 #include "../util/timer.h"
@@ -31,37 +33,93 @@ namespace polaris::limit
 	constexpr i32 DefaultMoveOverhead = 10;
 	constexpr util::Range<i32> MoveOverheadRange{0, 50000};
 
+	// nodes per millisecond when time is counted in nodes, 0 to use the clock
+	constexpr util::Range<i64> NodesTimeRange{0, 100000};
+
+	// time limiters check the clock about this often (in seconds), and at least
+	// 4 times over the time left, whatever the speed of the host
+	constexpr f64 CheckPeriod = 0.0005;
+	constexpr util::Range<usize> CheckIntervalRange{16, 65536};
+
+	// nodes until the next check at the main thread's nps so far
+	[[nodiscard]] auto adaptiveCheckInterval(usize nodes, f64 elapsed, f64 timeLeft) -> usize;
+
+	// derives a move overhead from the engine's own latency over recent searches -
+	// from go arriving to the search starting, and from it being stopped to bestmove
+	// being flushed. delays between the gui and the engine are invisible to it
+	class OverheadTracker
+	{
+	public:
+		static constexpr usize MaxSamples = 64;
+		static constexpr usize MinSamples = 8;
+
+		auto addSample(f64 latency) -> void;
+
+		[[nodiscard]] inline auto sampleCount() const
+		{
+			return std::min(m_total, MaxSamples);
+		}
+
+		// 95th percentile of the kept samples, in seconds
+		[[nodiscard]] auto percentile() const -> f64;
+
+		// in ms, twice the 95th percentile latency plus a millisecond,
+		// once there are enough samples to go by
+		[[nodiscard]] auto overhead() const -> std::optional<i32>;
+
+	private:
+		std::array<f64, MaxSamples> m_samples{};
+		usize m_total{};
+	};
+
 	class MoveTimeLimiter final : public ISearchLimiter
 	{
 	public:
 		explicit MoveTimeLimiter(i64 time, i64 overhead = 0);
 		~MoveTimeLimiter() final = default;
 
+		[[nodiscard]] auto checkInterval(const search::SearchData &data) const -> usize final;
+
 		[[nodiscard]] auto stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool final;
 
 	private:
+		f64 m_startTime;
 		f64 m_maxTime;
 	};
 
 	class TimeManager final : public ISearchLimiter
 	{
 	public:
-		TimeManager(f64 start, f64 remaining, f64 increment, i32 toGo, f64 overhead);
+		// with nodesTime set, time is measured in nodes searched by the main thread
+		// instead of on the clock, at nodesTime nodes per millisecond
+		TimeManager(f64 start, f64 remaining, f64 increment, i32 toGo, f64 overhead, i64 nodesTime = 0);
 		~TimeManager() final = default;
 
-		auto update(const search::SearchData &data, Move bestMove, usize totalNodes) -> void final;
+		auto update(const search::SearchData &data, Score score, Move bestMove, usize totalNodes) -> void final;
 		auto updateMoveNodes(Move move, usize nodes) -> void final;
 
+		[[nodiscard]] auto checkInterval(const search::SearchData &data) const -> usize final;
+
 		[[nodiscard]] auto stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool final;
 
 	private:
+		[[nodiscard]] auto elapsed(const search::SearchData &data) const -> f64;
+
 		f64 m_startTime;
+		i64 m_nodesTime;
 
 		f64 m_softTime{};
 		f64 m_maxTime{};
 
 		f64 m_scale{1.0};
 
+		Move m_prevBestMove{};
+		// iterations the best move has not changed for
+		i32 m_stability{};
+
+		Score m_prevScore{};
+		bool m_hasPrevScore{false};
+
 		std::array<std::array<usize, 64>, 64> m_moveNodeCounts{};
 	};
 }
@@ -43,6 +43,12 @@ namespace polaris::limit
 
 		~NodeLimiter() final = default;
 
+		// checked again right at the limit, so node limited searches stop exactly there
+		[[nodiscard]] inline auto checkInterval(const search::SearchData &data) const -> usize final
+		{
+			return data.nodes < m_maxNodes ? m_maxNodes - data.nodes : 1;
+		}
+
 		[[nodiscard]] inline auto stop(const search::SearchData &data, bool allowSoftTimeout) const -> bool final
 		{
 			return data.nodes >= m_maxNodes;
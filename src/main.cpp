@@ -18,18 +18,40 @@
 
 #include "uci.h"
 #include "bench.h"
+#include "perft.h"
+#include "search.h"
+#include "eval/nnue.h"
+#include "attacks/attacks.h"
+#include "arch.h"
 
 using namespace polaris;
 
+#if PS_AUTO_FLAVOUR
+namespace polaris
+{
+	// each engine copy in polaris-auto is entered through this, from the main in dispatch.cpp
+	auto run(i32 argc, const char *argv[]) -> i32;
+}
+
+auto polaris::run(i32 argc, const char *argv[]) -> i32
+#else
 auto main(i32 argc, const char *argv[]) -> i32
+#endif
 {
-	if (argc > 1 && std::string{argv[1]} == "bench")
+	attacks::init();
+	search::init();
+	eval::nnue::init();
+
+	if (argc > 1 && (std::string{argv[1]} == "bench" || std::string{argv[1]} == "jsonbench"))
 	{
 		search::Searcher searcher{16};
-		bench::run(searcher);
+		bench::run(searcher, bench::DefaultBenchDepth, {}, std::string{argv[1]} == "jsonbench");
 
 		return 0;
 	}
 
+	if (argc > 1 && std::string{argv[1]} == "perftsuite")
+		return perftSuite() ? 0 : 1;
+
 	return uci::run();
 }
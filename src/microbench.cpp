@@ -0,0 +1,397 @@
+/*
+ * Polaris, a UCI chess engine
+ * Copyright (C) 2023 Ciekce
+ *
+ * Polaris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Polaris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Polaris. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "types.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <functional>
+
+#include "arch.h"
+#include "bench.h"
+#include "position/position.h"
+#include "movegen.h"
+#include "see.h"
+#include "ttable.h"
+#include "eval/eval.h"
+#include "eval/nnue.h"
+#include "attacks/attacks.h"
+#include "util/parse.h"
+#include "util/timer.h"
+
+// times the engine's hot paths in isolation over the bench positions
+// usage: polaris-microbench [filter] [repetitions]
+
+using namespace polaris;
+
+namespace
+{
+	constexpr u32 DefaultRepetitions = 10;
+
+	// each repetition is scaled to take about this long
+	constexpr f64 TargetRepetitionTime = 0.05;
+	constexpr f64 WarmupTime = 0.1;
+
+	// keeps results from being optimised out
+	volatile u64 s_sink{};
+
+	struct Summary
+	{
+		f64 min;
+		f64 median;
+		f64 mean;
+		f64 stddev;
+	};
+
+	auto summarise(std::vector<f64> samples)
+	{
+		std::ranges::sort(samples);
+
+		const auto n = static_cast<f64>(samples.size());
+		const auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+
+		f64 variance{};
+		for (const auto sample : samples)
+		{
+			variance += (sample - mean) * (sample - mean);
+		}
+
+		const auto mid = samples.size() / 2;
+		const auto median = samples.size() % 2 == 0
+			? (samples[mid - 1] + samples[mid]) / 2.0
+			: samples[mid];
+
+		return Summary {
+			.min = samples.front(),
+			.median = median,
+			.mean = mean,
+			.stddev = samples.size() > 1 ? std::sqrt(variance / (n - 1.0)) : 0.0
+		};
+	}
+
+	class MicroBench
+	{
+	public:
+		MicroBench(std::string_view filter, u32 repetitions)
+			: m_filter{filter}, m_repetitions{repetitions} {}
+
+		// pass performs one run over the inputs and returns the number of operations done
+		auto run(std::string_view name, const std::function<usize()> &pass) -> void
+		{
+			if (!m_filter.empty() && name.find(m_filter) == std::string_view::npos)
+				return;
+
+			// warms caches and branch predictors, and sizes the repetitions
+			usize passes{};
+			usize ops{};
+
+			const auto warmupStart = util::g_timer.time();
+			f64 warmupTime{};
+
+			do
+			{
+				ops = pass();
+				++passes;
+			} while ((warmupTime = util::g_timer.time() - warmupStart) < WarmupTime);
+
+			const auto passesPerRep = std::max<usize>(1,
+				static_cast<usize>(TargetRepetitionTime / (warmupTime / static_cast<f64>(passes))));
+
+			std::vector<f64> samples{};
+			samples.reserve(m_repetitions);
+
+			for (u32 rep = 0; rep < m_repetitions; ++rep)
+			{
+				const auto start = util::g_timer.time();
+
+				for (usize i = 0; i < passesPerRep; ++i)
+				{
+					pass();
+				}
+
+				const auto time = util::g_timer.time() - start;
+				samples.push_back(time * 1e9 / static_cast<f64>(passesPerRep * ops));
+			}
+
+			const auto [min, median, mean, stddev] = summarise(std::move(samples));
+
+			std::cout << std::left << std::setw(24) << name << std::right
+				<< std::fixed << std::setprecision(2)
+				<< std::setw(10) << min
+				<< std::setw(10) << median
+				<< std::setw(10) << mean
+				<< std::setw(10) << stddev
+				<< std::setw(12) << ops
+				<< std::defaultfloat << std::endl;
+		}
+
+		static auto printHeader() -> void
+		{
+			std::cout << std::left << std::setw(24) << "ns/op" << std::right
+				<< std::setw(10) << "min"
+				<< std::setw(10) << "median"
+				<< std::setw(10) << "mean"
+				<< std::setw(10) << "stddev"
+				<< std::setw(12) << "ops/pass" << std::endl;
+		}
+
+	private:
+		std::string_view m_filter;
+		u32 m_repetitions;
+	};
+}
+
+auto main(i32 argc, const char *argv[]) -> i32
+{
+	attacks::init();
+	eval::nnue::init();
+
+	const std::string_view filter = argc > 1 ? argv[1] : "";
+	u32 repetitions = DefaultRepetitions;
+
+	if (argc > 2)
+	{
+		if (const auto parsed = util::tryParseU32(argv[2]); parsed && *parsed > 0)
+			repetitions = *parsed;
+		else
+		{
+			std::cerr << "invalid repetition count " << argv[2] << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<Position> positions{};
+	std::vector<ScoredMoveList> moves{};
+	std::vector<ScoredMoveList> noisies{};
+
+	for (const auto fen : bench::defaultFens())
+	{
+		auto pos = *Position::fromFen(fen);
+		pos.setNnue(false);
+
+		auto &all = moves.emplace_back();
+		generateAll(all, pos);
+
+		auto &noisy = noisies.emplace_back();
+		generateNoisy(noisy, pos);
+
+		positions.push_back(std::move(pos));
+	}
+
+	std::cout << "polaris microbench, build " << ArchName << " (" << attacks::backendName()
+		<< " attacks), " << positions.size() << " positions, "
+		<< repetitions << " repetitions" << std::endl;
+	std::cout << "network " << (eval::nnue::networkLoaded() ? "loaded" : "not loaded, timing a zeroed network")
+		<< "\n" << std::endl;
+
+	MicroBench bench{filter, repetitions};
+	MicroBench::printHeader();
+
+	const auto makeUnmake = [&]
+	{
+		usize ops{};
+
+		for (usize i = 0; i < positions.size(); ++i)
+		{
+			auto &pos = positions[i];
+
+			for (const auto [move, see, score] : moves[i])
+			{
+				s_sink = pos.applyMoveUnchecked(move);
+				pos.popMove();
+				++ops;
+			}
+		}
+
+		return ops;
+	};
+
+	bench.run("make/unmake (hce)", makeUnmake);
+
+	for (auto &pos : positions)
+	{
+		pos.setNnue(true);
+	}
+
+	bench.run("make/unmake (nnue)", makeUnmake);
+
+	bench.run("generateNoisy", [&]
+	{
+		for (const auto &pos : positions)
+		{
+			ScoredMoveList list{};
+			generateNoisy(list, pos);
+			s_sink = list.size();
+		}
+
+		return positions.size();
+	});
+
+	bench.run("generateQuiet", [&]
+	{
+		for (const auto &pos : positions)
+		{
+			ScoredMoveList list{};
+			generateQuiet(list, pos);
+			s_sink = list.size();
+		}
+
+		return positions.size();
+	});
+
+	bench.run("staticEval (nnue)", [&]
+	{
+		for (const auto &pos : positions)
+		{
+			s_sink = static_cast<u64>(eval::staticEval(pos));
+		}
+
+		return positions.size();
+	});
+
+	for (auto &pos : positions)
+	{
+		pos.setNnue(false);
+	}
+
+	bench.run("staticEval (hce)", [&]
+	{
+		for (const auto &pos : positions)
+		{
+			s_sink = static_cast<u64>(eval::staticEval(pos));
+		}
+
+		return positions.size();
+	});
+
+	bench.run("see", [&]
+	{
+		usize ops{};
+
+		for (usize i = 0; i < positions.size(); ++i)
+		{
+			for (const auto [move, see, score] : noisies[i])
+			{
+				s_sink = see::see(positions[i], move);
+				++ops;
+			}
+		}
+
+		return ops;
+	});
+
+	{
+		// keys of every position one legal move from the bench positions
+		std::vector<u64> keys{};
+
+		for (usize i = 0; i < positions.size(); ++i)
+		{
+			auto &pos = positions[i];
+
+			for (const auto [move, see, score] : moves[i])
+			{
+				if (const auto guard = pos.applyMove(move))
+					keys.push_back(pos.key());
+			}
+		}
+
+		TTable table{64};
+
+		bench.run("TTable::put", [&]
+		{
+			for (const auto key : keys)
+			{
+				table.put(key, static_cast<Score>(key & 0xFF), NullMove, 8, 0, EntryType::Exact);
+			}
+
+			return keys.size();
+		});
+
+		bench.run("TTable::probe", [&]
+		{
+			ProbedTTableEntry entry{};
+
+			for (const auto key : keys)
+			{
+				s_sink = table.probe(entry, key, 8, 0, -ScoreMate, ScoreMate);
+			}
+
+			return keys.size();
+		});
+	}
+
+	{
+		std::vector<std::pair<Square, Bitboard>> lookups{};
+
+		for (const auto &pos : positions)
+		{
+			for (i32 square = 0; square < 64; ++square)
+			{
+				lookups.emplace_back(static_cast<Square>(square), pos.boards().occupancy());
+			}
+		}
+
+		bench.run("getRookAttacks", [&]
+		{
+			u64 result{};
+
+			for (const auto [square, occupancy] : lookups)
+			{
+				result ^= attacks::getRookAttacks(square, occupancy);
+			}
+
+			s_sink = result;
+			return lookups.size();
+		});
+
+		bench.run("getBishopAttacks", [&]
+		{
+			u64 result{};
+
+			for (const auto [square, occupancy] : lookups)
+			{
+				result ^= attacks::getBishopAttacks(square, occupancy);
+			}
+
+			s_sink = result;
+			return lookups.size();
+		});
+
+		bench.run("getQueenAttacks", [&]
+		{
+			u64 result{};
+
+			for (const auto [square, occupancy] : lookups)
+			{
+				result ^= attacks::getQueenAttacks(square, occupancy);
+			}
+
+			s_sink = result;
+			return lookups.size();
+		});
+	}
+
+	return 0;
+}
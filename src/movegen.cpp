@@ -38,7 +38,7 @@ namespace polaris
 				const auto dstSquare = board.popLowestSquare();
 				const auto srcSquare = static_cast<Square>(static_cast<i32>(dstSquare) - offset);
 
-				dst.push({Move::standard(srcSquare, dstSquare), 0});
+				dst.push({Move::standard(srcSquare, dstSquare)});
 			}
 		}
 
@@ -47,7 +47,7 @@ namespace polaris
 			while (!board.empty())
 			{
 				const auto dstSquare = board.popLowestSquare();
-				dst.push({Move::standard(srcSquare, dstSquare), 0});
+				dst.push({Move::standard(srcSquare, dstSquare)});
 			}
 		}
 
@@ -58,7 +58,7 @@ namespace polaris
 				const auto dstSquare = board.popLowestSquare();
 				const auto srcSquare = static_cast<Square>(static_cast<i32>(dstSquare) - offset);
 
-				noisy.push({Move::promotion(srcSquare, dstSquare, BasePiece::Queen), 0});
+				noisy.push({Move::promotion(srcSquare, dstSquare, BasePiece::Queen)});
 			}
 		}
 
@@ -69,15 +69,15 @@ namespace polaris
 				const auto dstSquare = board.popLowestSquare();
 				const auto srcSquare = static_cast<Square>(static_cast<i32>(dstSquare) - offset);
 
-				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Knight), 0});
-				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Rook), 0});
-				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Bishop), 0});
+				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Knight)});
+				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Rook)});
+				quiet.push({Move::promotion(srcSquare, dstSquare, BasePiece::Bishop)});
 			}
 		}
 
 		inline auto pushCastling(ScoredMoveList &dst, Square srcSquare, Square dstSquare)
 		{
-			dst.push({Move::castling(srcSquare, dstSquare), 0});
+			dst.push({Move::castling(srcSquare, dstSquare)});
 		}
 
 		inline auto pushEnPassants(ScoredMoveList &noisy, i32 offset, Bitboard board)
@@ -87,7 +87,7 @@ namespace polaris
 				const auto dstSquare = board.popLowestSquare();
 				const auto srcSquare = static_cast<Square>(static_cast<i32>(dstSquare) - offset);
 
-				noisy.push({Move::enPassant(srcSquare, dstSquare), 0});
+				noisy.push({Move::enPassant(srcSquare, dstSquare)});
 			}
 		}
 
@@ -20,6 +20,8 @@
 
 #include "types.h"
 
+#include <limits>
+
 #include "move.h"
 #include "position/position.h"
 #include "see.h"
@@ -29,10 +31,17 @@ namespace polaris
 {
 	struct ScoredMove
 	{
+		// fits in the padding after the move
+		static constexpr i16 NoSee = std::numeric_limits<i16>::min();
+
 		Move move;
-		i32 score;
+		// exact see value, if move ordering needed it
+		i16 see{NoSee};
+		i32 score{};
 	};
 
+	static_assert(sizeof(ScoredMove) == 8);
+
 	using ScoredMoveList = StaticVector<ScoredMove, DefaultMoveListCapacity>;
 
 	auto generateNoisy(ScoredMoveList &noisy, const Position &pos) -> void;
@@ -57,23 +66,25 @@ namespace polaris
 	{
 	public:
 		MoveGenerator(const Position &pos, Move killer, ScoredMoveList &moves, Move ttMove,
-			HistoryMove prevMove = {}, HistoryMove prevPrevMove = {}, const HistoryTable *history = nullptr)
+			HistoryMove prevMove = {}, const ContinuationEntries *conts = nullptr, const HistoryTable *history = nullptr)
 			: m_pos{pos},
 			  m_moves{moves},
 			  m_ttMove{ttMove},
 			  m_prevMove{prevMove},
-			  m_prevPrevMove{prevPrevMove},
+			  m_conts{conts},
 			  m_killer{killer},
 			  m_history{history}
 		{
 			m_moves.clear();
-			m_moves.fill({NullMove, 0});
+			m_moves.fill({NullMove});
 		}
 
 		~MoveGenerator() = default;
 
 		[[nodiscard]] inline auto next()
 		{
+			m_lastSee = ScoredMove::NoSee;
+
 			while (true)
 			{
 				while (m_idx == m_moves.size() || m_idx == m_goodNoisyEnd)
@@ -103,7 +114,7 @@ namespace polaris
 					case MovegenStage::Countermove:
 						if (m_history && m_prevMove)
 						{
-							m_countermove = m_history->entry(m_prevMove).countermove;
+							m_countermove = m_history->countermove(m_prevMove);
 							if (m_countermove
 								&& m_countermove != m_ttMove
 								&& m_countermove != m_killer
@@ -127,17 +138,29 @@ namespace polaris
 				if (m_idx == m_moves.size())
 					return NullMove;
 
-				const auto move = findNext();
+				const auto &entry = findNext();
 
-				if (move != m_ttMove
-					&& move != m_killer
-					&& move != m_countermove)
-					return move;
+				if (entry.move != m_ttMove
+					&& entry.move != m_killer
+					&& entry.move != m_countermove)
+				{
+					m_lastSee = entry.see;
+					return entry.move;
+				}
 			}
 		}
 
 		[[nodiscard]] inline auto stage() const { return m_stage; }
 
+		// see threshold test for the move last returned by next(), answered
+		// from the value cached by move ordering if there is one
+		[[nodiscard]] inline auto see(Move move, Score threshold) const
+		{
+			if (m_lastSee != ScoredMove::NoSee)
+				return m_lastSee >= threshold;
+			return see::see(m_pos, move, threshold);
+		}
+
 	private:
 		static constexpr auto Mvv = std::array {
 			10, // pawn
@@ -154,10 +177,10 @@ namespace polaris
 			 0  // queen
 		};
 
-		inline auto findNext()
+		inline auto findNext() -> const ScoredMove &
 		{
 			if (m_stage == MovegenStage::GoodNoisy)
-				return m_moves[m_idx++].move;
+				return m_moves[m_idx++];
 
 			auto best = m_idx;
 			auto bestScore = m_moves[m_idx].score;
@@ -174,7 +197,7 @@ namespace polaris
 			if (best != m_idx)
 				std::swap(m_moves[m_idx], m_moves[best]);
 
-			return m_moves[m_idx++].move;
+			return m_moves[m_idx++];
 		}
 
 		inline auto scoreNoisy()
@@ -198,8 +221,21 @@ namespace polaris
 				if (captured != Piece::None)
 					move.score += Mvv[static_cast<i32>(basePiece(captured))];
 
-				if ((captured != Piece::None || move.move.target() == BasePiece::Queen)
-					&& see::see(m_pos, move.move))
+				bool good = false;
+
+				// outright wins are never see pruned, so skip their swap-off
+				if (captured != Piece::None || move.move.target() == BasePiece::Queen)
+				{
+					if (see::winsOutright(boards, move.move))
+						good = true;
+					else
+					{
+						move.see = static_cast<i16>(see::value(m_pos, move.move));
+						good = move.see >= 0;
+					}
+				}
+
+				if (good)
 					move.score += 8 * 2000 * 2000;
 				else if (move.move.type() == MoveType::Promotion)
 					move.score += PromoScores[move.move.targetIdx()] * 2000;
@@ -218,12 +254,21 @@ namespace polaris
 				{
 					const auto historyMove = HistoryMove::from(boards, move.move);
 
-					move.score = m_history->entry(historyMove).score;
+					move.score = m_history->score(historyMove);
+
+					if (m_conts)
+					{
+						const auto &conts = *m_conts;
 
-					if (m_prevMove)
-						move.score += m_history->contEntry(m_prevMove).score(historyMove);
-					if (m_prevPrevMove)
-						move.score += m_history->contEntry(m_prevPrevMove).score(historyMove);
+						for (usize i = 0; i < conts.size(); ++i)
+						{
+							if (!conts[i])
+								continue;
+
+							const auto score = conts[i]->score(historyMove);
+							move.score += i < FullWeightContinuations ? score : score / 2;
+						}
+					}
 				}
 
 				// knight promos first, rook then bishop promos last
@@ -268,12 +313,14 @@ namespace polaris
 		Move m_ttMove;
 
 		HistoryMove m_prevMove;
-		HistoryMove m_prevPrevMove;
+		const ContinuationEntries *m_conts;
 
 		Move m_killer;
 
 		Move m_countermove{NullMove};
 
+		i16 m_lastSee{ScoredMove::NoSee};
+
 		const HistoryTable *m_history;
 
 		u32 m_idx{};
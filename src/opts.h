@@ -29,7 +29,16 @@ namespace polaris
 		bool syzygyEnabled{false};
 		i32 syzygyProbeDepth{1};
 		i32 syzygyProbeLimit{7};
+
+#ifdef PS_NETWORK_FILE
+		bool useNnue{true};
+#else
+		bool useNnue{false};
+#endif
 	};
 
 	extern const GlobalOptions &g_opts;
+
+	// for built-in commands that have to change options temporarily
+	[[nodiscard]] auto mutableOpts() -> GlobalOptions &;
 }
@@ -19,8 +19,20 @@
 #include "perft.h"
 
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <array>
+#include <string_view>
+#include <iomanip>
 
+#include "arch.h"
+#include "attacks/attacks.h"
+#include "opts.h"
 #include "movegen.h"
+#include "rays.h"
 #include "uci.h"
 #include "util/timer.h"
 
@@ -28,69 +40,366 @@ namespace polaris
 {
 	namespace
 	{
-		auto doPerft(Position &pos, i32 depth) -> usize
+		// lockless, like the search tt - the key is stored xored with
+		// the data, so entries torn by concurrent writes fail to verify
+		class PerftTable
+		{
+		public:
+			explicit PerftTable(usize size)
+			{
+				size *= 1024 * 1024;
+
+				const usize capacity = std::bit_floor(size / sizeof(Entry));
+
+				m_table.resize(capacity);
+				m_mask = capacity == 0 ? 0 : capacity - 1;
+
+				if (capacity > 0)
+					std::memset(m_table.data(), 0, capacity * sizeof(Entry));
+			}
+
+			inline auto probe(u64 key, i32 depth, usize &nodes) const -> bool
+			{
+				if (m_table.empty())
+					return false;
+
+				const auto &entry = m_table[key & m_mask];
+
+				const auto check = __atomic_load_n(&entry.check, __ATOMIC_RELAXED);
+				const auto data = __atomic_load_n(&entry.data, __ATOMIC_RELAXED);
+
+				if ((check ^ data) != key || static_cast<i32>(data & 0xFF) != depth)
+					return false;
+
+				nodes = static_cast<usize>(data >> 8);
+				return true;
+			}
+
+			inline auto put(u64 key, i32 depth, usize nodes) -> void
+			{
+				if (m_table.empty())
+					return;
+
+				auto &entry = m_table[key & m_mask];
+
+				const auto data = (static_cast<u64>(nodes) << 8) | static_cast<u64>(depth);
+
+				__atomic_store_n(&entry.check, key ^ data, __ATOMIC_RELAXED);
+				__atomic_store_n(&entry.data, data, __ATOMIC_RELAXED);
+			}
+
+		private:
+			struct Entry
+			{
+				u64 check;
+				// node count in the upper 56 bits, depth in the lower 8
+				u64 data;
+			};
+
+			u64 m_mask{};
+			std::vector<Entry> m_table{};
+		};
+
+		// counts the legal moves in a pseudolegal list without making them, which
+		// is where nearly all of the time in perft goes. castling and en passant
+		// are rare and awkward to check (discovered attacks through two vacated
+		// squares, fischer random rooks), so those still go through applyMove
+		auto countLegal(Position &pos, const ScoredMoveList &moves) -> usize
+		{
+			const auto &boards = pos.boards();
+
+			const auto us = pos.toMove();
+			const auto them = oppColor(us);
+
+			const auto king = pos.king(us);
+			const auto checkers = pos.checkers();
+
+			const auto occupancy = boards.occupancy();
+
+			const auto pinned = pos.pinned(us);
+
+			// squares a non-king move has to land on to deal with a single check
+			const auto checkMask = checkers.empty()
+				? ~Bitboard{}
+				: rayBetween(king, checkers.lowestSquare()) | checkers;
+
+			const auto kinglessOcc = occupancy ^ squareBit(king);
+
+			usize total{};
+
+			for (const auto [move, see, score] : moves)
+			{
+				const auto type = move.type();
+
+				if (type == MoveType::Castling || type == MoveType::EnPassant)
+				{
+					if (const auto guard = pos.applyMove<false>(move))
+						++total;
+					continue;
+				}
+
+				const auto src = move.src();
+				const auto dst = move.dst();
+
+				if (src == king)
+				{
+					// sliders attacking the king see through the square it is leaving
+					if ((pos.allAttackersTo(dst, kinglessOcc) & boards.forColor(them)).empty())
+						++total;
+					continue;
+				}
+
+				if (checkers.multiple() || !checkMask[dst])
+					continue;
+
+				// a pinned piece may only move along the line through its king
+				if (pinned[src] && !rayBetween(king, dst)[src] && !rayBetween(king, src)[dst])
+					continue;
+
+				++total;
+			}
+
+			return total;
+		}
+
+		auto doPerft(Position &pos, i32 depth, PerftTable &table) -> usize
 		{
 			if (depth == 0)
 				return 1;
 
-			--depth;
+			usize total{};
 
-			const auto opp = pos.opponent();
+			if (depth > 1 && table.probe(pos.key(), depth, total))
+				return total;
 
 			ScoredMoveList moves{};
 			generateAll(moves, pos);
 
-			usize total{};
+			if (depth == 1)
+				return countLegal(pos, moves);
 
-			for (const auto [move, score] : moves)
+			for (const auto [move, see, score] : moves)
 			{
 				const auto guard = pos.applyMove<false>(move);
 
 				if (!guard)
 					continue;
 
-				total += depth == 0 ? 1 : doPerft(pos, depth);
+				total += doPerft(pos, depth - 1, table);
 			}
 
+			if (depth > 1)
+				table.put(pos.key(), depth, total);
+
 			return total;
 		}
+
+		struct RootMove
+		{
+			Move move;
+			usize nodes;
+		};
+
+		// fills in the node count of each legal root move, in generation order
+		auto perftRoot(const Position &pos, i32 depth, u32 threads, usize hashSize) -> std::vector<RootMove>
+		{
+			std::vector<RootMove> rootMoves{};
+
+			{
+				auto copy = pos;
+				copy.setNnue(false);
+
+				ScoredMoveList moves{};
+				generateAll(moves, copy);
+
+				for (const auto [move, see, score] : moves)
+				{
+					if (const auto guard = copy.applyMove<false>(move))
+						rootMoves.push_back({move, depth == 1 ? usize{1} : usize{0}});
+				}
+			}
+
+			if (depth == 1)
+				return rootMoves;
+
+			PerftTable table{hashSize};
+
+			std::atomic<usize> nextMove{};
+
+			const auto worker = [&]
+			{
+				auto copy = pos;
+				copy.setNnue(false);
+
+				for (auto idx = nextMove.fetch_add(1, std::memory_order::relaxed);
+					idx < rootMoves.size();
+					idx = nextMove.fetch_add(1, std::memory_order::relaxed))
+				{
+					auto &rootMove = rootMoves[idx];
+
+					const auto guard = copy.applyMove<false>(rootMove.move);
+					rootMove.nodes = doPerft(copy, depth - 1, table);
+				}
+			};
+
+			threads = std::min<u32>(threads, std::max<u32>(static_cast<u32>(rootMoves.size()), 1));
+
+			std::vector<std::thread> helpers{};
+			helpers.reserve(threads - 1);
+
+			for (u32 i = 1; i < threads; ++i)
+			{
+				helpers.emplace_back(worker);
+			}
+
+			worker();
+
+			for (auto &helper : helpers)
+			{
+				helper.join();
+			}
+
+			return rootMoves;
+		}
+
+		struct SuitePosition
+		{
+			std::string_view fen;
+			bool chess960;
+			i32 depth;
+			usize nodes;
+		};
+
+		constexpr auto SuitePositions = std::array {
+			SuitePosition{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", false, 6, 119060324},
+			SuitePosition{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", false, 5, 193690690},
+			SuitePosition{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", false, 7, 178633661},
+			SuitePosition{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", false, 5, 15833292},
+			SuitePosition{"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", false, 5, 15833292},
+			SuitePosition{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", false, 5, 89941194},
+			SuitePosition{"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", false, 5, 164075551},
+			SuitePosition{"bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9", true, 5, 8146062},
+			SuitePosition{"2nnrbkr/p1qppppp/8/1ppb4/6PP/3PP3/PPP2P2/BQNNRBKR w HEhe - 1 9", true, 5, 16253601},
+			SuitePosition{"b1q1rrkb/pppppppp/3nn3/8/P7/1PPP4/4PPPP/BQNNRKRB w GE - 1 9", true, 5, 6417013},
+			SuitePosition{"qbbnnrkr/2pp2pp/p7/1p2pp2/8/P3PP2/1PPP1KPP/QBBNNR1R w hf - 0 9", true, 5, 9183776},
+			SuitePosition{"1nbbnrkr/p1p1ppp1/3p4/1p3P1p/3Pq2P/8/PPP1P1P1/QNBBNRKR w HFhf - 0 9", true, 5, 34030312},
+			SuitePosition{"qnbnr1kr/ppp1b1pp/4p3/3p1p2/8/2NPP3/PPP1BPPP/QNB1R1KR w HEhe - 1 9", true, 5, 24851983},
+		};
+
+		auto printStats(usize nodes, f64 time)
+		{
+			const auto nps = static_cast<usize>(static_cast<f64>(nodes) / time);
+
+			std::cout << time << " seconds\n";
+			std::cout << nps << " nps" << std::endl;
+		}
 	}
 
-	auto perft(Position &pos, i32 depth) -> void
+	auto perft(const Position &pos, i32 depth, u32 threads, usize hashSize) -> void
 	{
-		std::cout << doPerft(pos, depth) << std::endl;
+		if (depth == 0)
+		{
+			std::cout << 1 << std::endl;
+			return;
+		}
+
+		const auto start = util::g_timer.time();
+
+		usize total{};
+
+		for (const auto &rootMove : perftRoot(pos, depth, threads, hashSize))
+		{
+			total += rootMove.nodes;
+		}
+
+		const auto time = util::g_timer.time() - start;
+
+		std::cout << total << '\n';
+		printStats(total, time);
 	}
 
-	auto splitPerft(Position &pos, i32 depth) -> void
+	auto splitPerft(const Position &pos, i32 depth, u32 threads, usize hashSize) -> void
 	{
-		--depth;
-
-		const auto opp = pos.opponent();
+		if (depth == 0)
+		{
+			std::cout << "\ntotal 1" << std::endl;
+			return;
+		}
 
 		const auto start = util::g_timer.time();
 
-		ScoredMoveList moves{};
-		generateAll(moves, pos);
+		const auto rootMoves = perftRoot(pos, depth, threads, hashSize);
+
+		const auto time = util::g_timer.time() - start;
 
 		usize total{};
 
-		for (const auto [move, score] : moves)
+		for (const auto &[move, nodes] : rootMoves)
 		{
-			const auto guard = pos.applyMove<false>(move);
+			total += nodes;
+			std::cout << uci::moveToString(move) << '\t' << nodes << '\n';
+		}
 
-			if (!guard)
+		std::cout << "\ntotal " << total << '\n';
+		printStats(total, time);
+	}
+
+	auto perftSuite() -> bool
+	{
+		auto &opts = mutableOpts();
+		const auto prevChess960 = opts.chess960;
+
+		usize totalNodes{};
+		f64 totalTime{};
+
+		u32 failed{};
+
+		for (const auto &[fen, chess960, depth, expected] : SuitePositions)
+		{
+			// castling rights are parsed differently in chess960 fens
+			opts.chess960 = chess960;
+
+			const auto pos = Position::fromFen(std::string{fen});
+
+			if (!pos)
+			{
+				std::cout << "FAIL  invalid fen " << fen << std::endl;
+				++failed;
 				continue;
+			}
 
-			const auto value = doPerft(pos, depth);
+			const auto start = util::g_timer.time();
+
+			usize nodes{};
+
+			for (const auto &rootMove : perftRoot(*pos, depth, 1, 0))
+			{
+				nodes += rootMove.nodes;
+			}
 
-			total += value;
-			std::cout << uci::moveToString(move) << '\t' << value << '\n';
+			const auto time = util::g_timer.time() - start;
+
+			totalNodes += nodes;
+			totalTime += time;
+
+			const bool passed = nodes == expected;
+
+			if (!passed)
+				++failed;
+
+			std::cout << (passed ? "pass  " : "FAIL  ") << fen << " depth " << depth
+				<< ": " << nodes << " (expected " << expected << ") "
+				<< std::fixed << std::setprecision(3) << time << "s" << std::defaultfloat << std::endl;
 		}
 
-		const auto time = util::g_timer.time() - start;
-		const auto nps = static_cast<usize>(static_cast<f64>(total) / time);
+		opts.chess960 = prevChess960;
 
-		std::cout << "\ntotal " << total << '\n';
-		std::cout << nps << " nps" << std::endl;
+		std::cout << '\n' << (SuitePositions.size() - failed) << '/' << SuitePositions.size()
+			<< " passed, build " << ArchName
+			<< " (" << attacks::backendName() << " attacks)\n";
+		std::cout << totalNodes << " nodes\n";
+		printStats(totalNodes, totalTime);
+
+		return failed == 0;
 	}
 }
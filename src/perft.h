@@ -22,9 +22,19 @@
 
 #include "core.h"
 #include "position/position.h"
+#include "util/range.h"
 
 namespace polaris
 {
-	auto perft(Position &pos, i32 depth) -> void;
-	auto splitPerft(Position &pos, i32 depth) -> void;
+	constexpr auto PerftThreadsRange = util::Range<u32>{1, 2048};
+	// in MB, 0 disables the perft hash table
+	constexpr auto PerftHashSizeRange = util::Range<usize>{0, 131072};
+
+	// root moves are shared out between threads, which share the hash table
+	auto perft(const Position &pos, i32 depth, u32 threads = 1, usize hashSize = 0) -> void;
+	auto splitPerft(const Position &pos, i32 depth, u32 threads = 1, usize hashSize = 0) -> void;
+
+	// standard and chess960 positions with known counts, single threaded without
+	// the hash table so the nps reflects raw movegen speed. returns false on a mismatch
+	auto perftSuite() -> bool;
 }
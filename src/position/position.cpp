@@ -100,12 +100,21 @@ namespace polaris
 #endif
 
 	Position::Position(bool init)
+		: m_nnue{g_opts.useNnue}
 	{
 		m_states.reserve(256);
 		m_hashes.reserve(512);
 
+		if (m_nnue)
+			m_accumulators.reserve(256);
+
 		if (init)
+		{
 			m_states.push_back({});
+
+			if (m_nnue)
+				m_accumulators.push_back({});
+		}
 	}
 
 	template <bool UpdateMaterial, bool StateHistory>
@@ -116,8 +125,13 @@ namespace polaris
 		prevState.lastMove = move;
 
 		if constexpr (StateHistory)
+		{
 			m_states.push_back(prevState);
 
+			if (m_nnue)
+				m_accumulators.push_back(m_accumulators.back());
+		}
+
 		m_hashes.push_back(prevState.key);
 
 		auto &state = currState();
@@ -252,6 +266,7 @@ namespace polaris
 			prefetchTt->prefetch(state.key);
 
 		state.checkers = calcCheckers();
+		updatePinned();
 
 		state.phase = std::clamp(state.phase, 0, 24);
 
@@ -276,6 +291,9 @@ namespace polaris
 		m_states.pop_back();
 		m_hashes.pop_back();
 
+		if (m_nnue)
+			m_accumulators.pop_back();
+
 		m_blackToMove = !m_blackToMove;
 
 		if (!currState().lastMove)
@@ -533,8 +551,13 @@ namespace polaris
 		state.phase += PhaseInc[static_cast<usize>(piece)];
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material += eval::pieceSquareValue(piece, square);
 
+			if (m_nnue)
+				currAccumulator().activate(piece, square);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(piece, square);
@@ -555,8 +578,13 @@ namespace polaris
 		state.phase -= PhaseInc[static_cast<usize>(piece)];
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material -= eval::pieceSquareValue(piece, square);
 
+			if (m_nnue)
+				currAccumulator().deactivate(piece, square);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(piece, square);
@@ -577,8 +605,13 @@ namespace polaris
 			state.king(pieceColor(piece)) = dst;
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material += eval::pieceSquareValue(piece, dst) - eval::pieceSquareValue(piece, src);
 
+			if (m_nnue)
+				currAccumulator().move(piece, src, dst);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(piece, src) ^ hash::pieceSquare(piece, dst);
@@ -601,8 +634,13 @@ namespace polaris
 			state.phase -= PhaseInc[static_cast<usize>(captured)];
 
 			if constexpr (UpdateMaterial)
+			{
 				state.material -= eval::pieceSquareValue(captured, dst);
 
+				if (m_nnue)
+					currAccumulator().deactivate(captured, dst);
+			}
+
 			if constexpr (UpdateKey)
 			{
 				const auto hash = hash::pieceSquare(captured, dst);
@@ -618,8 +656,13 @@ namespace polaris
 			state.king(pieceColor(piece)) = dst;
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material += eval::pieceSquareValue(piece, dst) - eval::pieceSquareValue(piece, src);
 
+			if (m_nnue)
+				currAccumulator().move(piece, src, dst);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(piece, src) ^ hash::pieceSquare(piece, dst);
@@ -645,8 +688,13 @@ namespace polaris
 			state.phase -= PhaseInc[static_cast<usize>(captured)];
 
 			if constexpr (UpdateMaterial)
+			{
 				state.material -= eval::pieceSquareValue(captured, dst);
 
+				if (m_nnue)
+					currAccumulator().deactivate(captured, dst);
+			}
+
 			// cannot capture a pawn when promoting
 			if constexpr (UpdateKey)
 				state.key ^= hash::pieceSquare(captured, dst);
@@ -659,9 +707,14 @@ namespace polaris
 			const auto coloredTarget = copyPieceColor(pawn, target);
 
 			if constexpr (UpdateMaterial)
+			{
 				state.material += eval::pieceSquareValue(coloredTarget, dst)
 					- eval::pieceSquareValue(pawn, src);
 
+				if (m_nnue)
+					currAccumulator().moveAndChange(pawn, src, coloredTarget, dst);
+			}
+
 			if constexpr (UpdateKey)
 			{
 				const auto pawnHash = hash::pieceSquare(pawn, src);
@@ -721,9 +774,14 @@ namespace polaris
 		state.boards.movePiece(src, dst, pawn);
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material += eval::pieceSquareValue(pawn, dst)
 				- eval::pieceSquareValue(pawn, src);
 
+			if (m_nnue)
+				currAccumulator().move(pawn, src, dst);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(pawn, src) ^ hash::pieceSquare(pawn, dst);
@@ -744,8 +802,13 @@ namespace polaris
 		// pawns do not affect game phase
 
 		if constexpr (UpdateMaterial)
+		{
 			state.material -= eval::pieceSquareValue(enemyPawn, captureSquare);
 
+			if (m_nnue)
+				currAccumulator().deactivate(enemyPawn, captureSquare);
+		}
+
 		if constexpr (UpdateKey)
 		{
 			const auto hash = hash::pieceSquare(enemyPawn, captureSquare);
@@ -770,6 +833,27 @@ namespace polaris
 
 			state.material += eval::pieceSquareValue(piece, square);
 		}
+
+		if (m_nnue)
+			currAccumulator().refresh(state.boards);
+	}
+
+	auto Position::setNnue(bool enabled) -> void
+	{
+		m_nnue = enabled;
+
+		if (!m_nnue)
+		{
+			m_accumulators.clear();
+			return;
+		}
+
+		m_accumulators.resize(m_states.size());
+
+		for (usize i = 0; i < m_states.size(); ++i)
+		{
+			m_accumulators[i].refresh(m_states[i].boards);
+		}
 	}
 
 	template <bool EnPassantFromMoves>
@@ -837,6 +921,7 @@ namespace polaris
 		state.key ^= hash::enPassant(state.enPassant);
 
 		state.checkers = calcCheckers();
+		updatePinned();
 	}
 
 #ifndef NDEBUG
@@ -901,6 +986,12 @@ namespace polaris
 				out << '\n';
 				failed = true;
 			}
+
+			if (m_nnue && currAccumulator().values != regened.currAccumulator().values)
+			{
+				out << "info string accumulators do not match\n";
+				failed = true;
+			}
 		}
 
 #undef PS_CHECK_PIECES
@@ -30,6 +30,8 @@
 #include "../move.h"
 #include "../attacks/attacks.h"
 #include "../ttable.h"
+#include "../eval/nnue.h"
+#include "../rays.h"
 
 namespace polaris
 {
@@ -41,6 +43,8 @@ namespace polaris
 		u64 pawnKey{};
 
 		Bitboard checkers{};
+		// pieces of each colour pinned to their own king, indexed by colour
+		std::array<Bitboard, 2> pinned{};
 
 		TaperedScore material{};
 		Score phase{};
@@ -76,7 +80,7 @@ namespace polaris
 		}
 	};
 
-	static_assert(sizeof(BoardState) == 112);
+	static_assert(sizeof(BoardState) == 128);
 
 	[[nodiscard]] inline auto squareToString(Square square)
 	{
@@ -147,6 +151,9 @@ namespace polaris
 
 		[[nodiscard]] inline auto material() const { return currState().material; }
 
+		[[nodiscard]] inline auto nnueEnabled() const { return m_nnue; }
+		[[nodiscard]] inline auto accumulator() const -> const auto & { return m_accumulators.back(); }
+
 		[[nodiscard]] inline auto halfmove() const { return currState().halfmove; }
 		[[nodiscard]] inline auto fullmove() const { return m_fullmove; }
 
@@ -291,6 +298,9 @@ namespace polaris
 
 		[[nodiscard]] inline auto checkers() const { return currState().checkers; }
 
+		[[nodiscard]] inline auto pinned(Color c) const { return currState().pinned[static_cast<i32>(c)]; }
+		[[nodiscard]] inline auto pinned() const { return pinned(toMove()); }
+
 		[[nodiscard]] inline auto isDrawn(bool threefold) const
 		{
 			// TODO handle mate
@@ -428,6 +438,9 @@ namespace polaris
 
 		auto regenMaterial() -> void;
 
+		// regenerates the whole accumulator stack when enabling
+		auto setNnue(bool enabled) -> void;
+
 		template <bool EnPassantFromMoves = false>
 		auto regen() -> void;
 
@@ -464,6 +477,8 @@ namespace polaris
 		template <bool UpdateKeys = true, bool UpdateMaterial = true>
 		auto enPassant(Piece pawn, Square src, Square dst) -> Piece;
 
+		[[nodiscard]] inline auto currAccumulator() -> auto & { return m_accumulators.back(); }
+
 		[[nodiscard]] inline auto calcCheckers() const
 		{
 			const auto color = toMove();
@@ -472,12 +487,53 @@ namespace polaris
 			return attackersTo(state.king(color), oppColor(color));
 		}
 
+		[[nodiscard]] inline auto calcPinned(Color color) const
+		{
+			const auto &boards = currState().boards;
+
+			const auto king = currState().king(color);
+			const auto them = oppColor(color);
+
+			const auto queens = boards.queens(them);
+
+			auto pinners = ((boards.bishops(them) | queens) & attacks::EmptyBoardBishops[static_cast<i32>(king)])
+				| ((boards.rooks(them) | queens) & attacks::EmptyBoardRooks[static_cast<i32>(king)]);
+
+			const auto occupancy = boards.occupancy();
+
+			Bitboard pinned{};
+
+			while (pinners)
+			{
+				const auto pinner = pinners.popLowestSquare();
+				const auto between = rayBetween(king, pinner) & occupancy;
+
+				if (!between.empty() && !between.multiple() && !(between & boards.forColor(color)).empty())
+					pinned |= between;
+			}
+
+			return pinned;
+		}
+
+		inline auto updatePinned() -> void
+		{
+			auto &state = currState();
+
+			state.pinned[0] = calcPinned(Color::Black);
+			state.pinned[1] = calcPinned(Color::White);
+		}
+
 		bool m_blackToMove{};
 
 		u32 m_fullmove{1};
 
+		// kept in lockstep with m_states when enabled, and only
+		// updated alongside the material score in each state
+		bool m_nnue{};
+
 		std::vector<BoardState> m_states{};
 		std::vector<u64> m_hashes{};
+		std::vector<eval::nnue::Accumulator> m_accumulators{};
 	};
 
 	HistoryGuard::~HistoryGuard()
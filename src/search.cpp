@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cassert>
+#include <iomanip>
 
 #include "uci.h"
 #include "movegen.h"
@@ -43,29 +44,193 @@ namespace polaris::search
 		constexpr f64 LmrBase = 0.77;
 		constexpr f64 LmrDivisor = 2.36;
 
-		[[nodiscard]] auto generateLmrTable()
+		// filled by init() rather than a static initialiser, which
+		// would run before polaris-auto has checked the cpu
+		std::array<std::array<i32, 256>, 256> LmrTable{};
+
+		inline auto drawScore(usize nodes)
+		{
+			return 2 - static_cast<Score>(nodes % 4);
+		}
+
+		// compiles away unless stats are enabled
+		inline auto countStat(usize &counter)
+		{
+			if constexpr (StatsEnabled)
+				++counter;
+		}
+
+		inline auto percent(usize count, usize total)
+		{
+			return total == 0 ? 0.0 : static_cast<f64>(count) * 100.0 / static_cast<f64>(total);
+		}
+
+		// ranks the root moves by dtz, or by wdl if the dtz tables are missing, and keeps
+		// the best ranked - every move that keeps a win (or failing that a draw) within the
+		// 50 move rule, then the fastest to zero the counter. empty if the probe failed
+		auto probeRootMoves(const Position &pos) -> std::vector<Move>
 		{
-			std::array<std::array<i32, 256>, 256> dst{};
+			static constexpr auto PromoPieces = std::array {
+				BasePiece::None,
+				BasePiece::Queen,
+				BasePiece::Rook,
+				BasePiece::Bishop,
+				BasePiece::Knight
+			};
+
+			const auto &boards = pos.boards();
+			const auto epSq = pos.enPassant();
+
+			// ~100 KiB, too big for the stack
+			auto tbMoves = std::make_unique<TbRootMoves>();
 
-			// neither can be 0
-			for (i32 depth = 1; depth < 256; ++depth)
+			const auto probe = [&](auto func, auto... extraArgs)
 			{
-				for (i32 moves = 1; moves < 256; ++moves)
+				return func(
+					boards.whiteOccupancy(),
+					boards.blackOccupancy(),
+					boards.kings(),
+					boards.queens(),
+					boards.rooks(),
+					boards.bishops(),
+					boards.knights(),
+					boards.pawns(),
+					pos.halfmove(), 0,
+					epSq == Square::None ? 0 : static_cast<i32>(epSq),
+					pos.toMove() == Color::White,
+					extraArgs...,
+					tbMoves.get()
+				) != 0;
+			};
+
+			if (!probe(tb_probe_root_dtz, false, true) && !probe(tb_probe_root_wdl, true))
+				return {};
+
+			if (tbMoves->size == 0)
+				return {};
+
+			i32 bestRank = std::numeric_limits<i32>::min();
+
+			for (u32 i = 0; i < tbMoves->size; ++i)
+			{
+				bestRank = std::max(bestRank, tbMoves->moves[i].tbRank);
+			}
+
+			// fathom only knows from, to and promotion, so match
+			// against our own moves to get the rest (en passant)
+			ScoredMoveList legalMoves{};
+			generateAll(legalMoves, pos);
+
+			std::vector<Move> rootMoves{};
+
+			for (u32 i = 0; i < tbMoves->size; ++i)
+			{
+				const auto &tbMove = tbMoves->moves[i];
+
+				if (tbMove.tbRank != bestRank)
+					continue;
+
+				const auto src = static_cast<Square>(TB_MOVE_FROM(tbMove.move));
+				const auto dst = static_cast<Square>(TB_MOVE_TO(tbMove.move));
+				const auto promo = PromoPieces[TB_MOVE_PROMOTES(tbMove.move)];
+
+				for (const auto [move, see, score] : legalMoves)
 				{
-					dst[depth][moves] = static_cast<i32>(LmrBase
-						+ std::log(static_cast<f64>(depth)) * std::log(static_cast<f64>(moves)) / LmrDivisor);
+					if (move.src() == src && move.dst() == dst
+						&& (move.type() == MoveType::Promotion ? move.target() : BasePiece::None) == promo)
+					{
+						rootMoves.push_back(move);
+						break;
+					}
 				}
 			}
 
-			return dst;
+			return rootMoves;
 		}
+	}
 
-		const auto LmrTable = generateLmrTable();
+	auto SearchStats::operator+=(const SearchStats &other) -> SearchStats &
+	{
+		searchNodes += other.searchNodes;
+		qsearchNodes += other.qsearchNodes;
 
-		inline auto drawScore(usize nodes)
+		ttProbes += other.ttProbes;
+		ttHits += other.ttHits;
+		ttCutoffs += other.ttCutoffs;
+
+		rfpCutoffs += other.rfpCutoffs;
+		nmpAttempts += other.nmpAttempts;
+		nmpCutoffs += other.nmpCutoffs;
+		futilityPrunes += other.futilityPrunes;
+		seePrunes += other.seePrunes;
+
+		lmrSearches += other.lmrSearches;
+		lmrResearches += other.lmrResearches;
+
+		betaCutoffs += other.betaCutoffs;
+		firstMoveCutoffs += other.firstMoveCutoffs;
+
+		for (usize i = 0; i < cutoffsByStage.size(); ++i)
 		{
-			return 2 - static_cast<Score>(nodes % 4);
+			cutoffsByStage[i] += other.cutoffsByStage[i];
+		}
+
+		return *this;
+	}
+
+	auto init() -> void
+	{
+		// neither can be 0
+		for (i32 depth = 1; depth < 256; ++depth)
+		{
+			for (i32 moves = 1; moves < 256; ++moves)
+			{
+				LmrTable[depth][moves] = static_cast<i32>(LmrBase
+					+ std::log(static_cast<f64>(depth)) * std::log(static_cast<f64>(moves)) / LmrDivisor);
+			}
+		}
+	}
+
+	auto printStats(const SearchStats &stats) -> void
+	{
+		const auto nodes = stats.searchNodes + stats.qsearchNodes;
+
+		const auto prevPrecision = std::cout.precision();
+		std::cout << std::fixed << std::setprecision(2);
+
+		std::cout << "info string nodes " << nodes << ", " << percent(stats.qsearchNodes, nodes) << "% in qsearch\n";
+
+		std::cout << "info string tt probes " << stats.ttProbes
+			<< ", " << percent(stats.ttHits, stats.ttProbes) << "% hits"
+			<< ", " << percent(stats.ttCutoffs, stats.ttProbes) << "% cutoffs\n";
+
+		std::cout << "info string beta cutoffs " << stats.betaCutoffs
+			<< ", " << percent(stats.firstMoveCutoffs, stats.betaCutoffs) << "% on the first move\n";
+
+		static constexpr auto StageNames = std::array {
+			"", "tt move", "good noisy", "killer", "countermove", "quiet", "bad noisy", ""
+		};
+
+		std::cout << "info string cutoffs by stage";
+
+		for (i32 stage = MovegenStage::TtMove; stage < MovegenStage::End; ++stage)
+		{
+			std::cout << (stage == MovegenStage::TtMove ? " " : ", ") << StageNames[stage]
+				<< ' ' << percent(stats.cutoffsByStage[stage], stats.betaCutoffs) << '%';
 		}
+
+		std::cout << '\n';
+
+		std::cout << "info string rfp " << stats.rfpCutoffs
+			<< ", nmp " << stats.nmpCutoffs << '/' << stats.nmpAttempts
+			<< " (" << percent(stats.nmpCutoffs, stats.nmpAttempts) << "%)"
+			<< ", futility " << stats.futilityPrunes
+			<< ", see " << stats.seePrunes << '\n';
+
+		std::cout << "info string lmr searches " << stats.lmrSearches
+			<< ", " << percent(stats.lmrResearches, stats.lmrSearches) << "% re-searched" << std::endl;
+
+		std::cout << std::defaultfloat << std::setprecision(prevPrecision);
 	}
 
 	Searcher::Searcher(std::optional<usize> hashSize)
@@ -74,6 +239,7 @@ namespace polaris::search
 		auto &threadData = m_threads.emplace_back();
 
 		threadData.id = m_nextThreadId++;
+		threadData.pawnCache.resize(m_pawnCacheSize);
 		threadData.thread = std::thread{[this, &threadData]
 		{
 			run(threadData);
@@ -82,18 +248,24 @@ namespace polaris::search
 
 	auto Searcher::newGame() -> void
 	{
+		// helper threads can still be finishing an iteration after the main
+		// thread has reported, and they share the tables cleared below
+		m_stop.store(true, std::memory_order::seq_cst);
+		waitForThreads(m_runningThreads);
+
+		m_clearingThreads.store(static_cast<i32>(m_threads.size()));
+		startThreads(ClearFlag);
+
+		// the shared tables are cleared here while the threads clear their own
 		m_table.clear();
+		m_pawnCache.clear();
 
-		for (auto &thread : m_threads)
-		{
-			thread.pawnCache.clear();
-			std::fill(thread.stack.begin(), thread.stack.end(), SearchStackEntry{});
-			thread.history.clear();
-		}
+		waitForThreads(m_clearingThreads);
+		setIdle();
 	}
 
-	auto Searcher::startSearch(const Position &pos,
-		i32 maxDepth, std::unique_ptr<limit::ISearchLimiter> limiter) -> void
+	auto Searcher::startSearch(const Position &pos, i32 maxDepth,
+		std::unique_ptr<limit::ISearchLimiter> limiter, f64 startTime) -> void
 	{
 		if (!limiter)
 		{
@@ -103,115 +275,109 @@ namespace polaris::search
 
 		const auto &boards = pos.boards();
 
-		// probe syzygy tb for a move
-		if (g_opts.syzygyEnabled
-			&& boards.occupancy().popcount() <= std::min(g_opts.syzygyProbeLimit, static_cast<i32>(TB_LARGEST)))
-		{
-			const auto epSq = pos.enPassant();
-			const auto result = tb_probe_root(
-				boards.whiteOccupancy(),
-				boards.blackOccupancy(),
-				boards.kings(),
-				boards.queens(),
-				boards.rooks(),
-				boards.bishops(),
-				boards.knights(),
-				boards.pawns(),
-				pos.halfmove(), 0,
-				epSq == Square::None ? 0 : static_cast<i32>(epSq),
-				pos.toMove() == Color::White,
-				nullptr
-			);
-
-			if (result != TB_RESULT_FAILED)
-			{
-				static constexpr auto PromoPieces = std::array {
-					BasePiece::None,
-					BasePiece::Queen,
-					BasePiece::Rook,
-					BasePiece::Bishop,
-					BasePiece::Knight
-				};
-
-				const auto wdl = TB_GET_WDL(result);
-
-				const auto score = wdl == TB_WIN ? ScoreTbWin
-					: wdl == TB_LOSS ? -ScoreTbWin
-					: 0; // draw
-
-				const auto src = static_cast<Square>(TB_GET_FROM(result));
-				const auto dst = static_cast<Square>(TB_GET_TO  (result));
-
-				const auto promo = PromoPieces[TB_GET_PROMOTES(result)];
-				const bool ep = TB_GET_EP(result);
-
-				const auto move = ep ? Move::enPassant(src, dst)
-					: promo != BasePiece::None ? Move::promotion(src, dst, promo)
-					: Move::standard(src, dst);
-
-				// for pv printing
-				m_threads[0].pos = pos;
-
-				report(m_threads[0], 1, move, 0.0, score, -ScoreMax, ScoreMax, true);
-				std::cout << "bestmove " << uci::moveToString(move) << std::endl;
-
-				return;
-			}
-		}
-
 		for (auto &thread : m_threads)
 		{
 			thread.maxDepth = maxDepth;
 			thread.search = SearchData{};
+			thread.nextLimiterCheck = 0;
+			thread.stats = SearchStats{};
 			thread.pos = pos;
 		}
 
+		m_rootMoves.clear();
+
+		if (g_opts.syzygyEnabled
+			&& pos.castlingRooks() == CastlingRooks{}
+			&& boards.occupancy().popcount() <= std::min(g_opts.syzygyProbeLimit, static_cast<i32>(TB_LARGEST)))
+		{
+			m_rootMoves = probeRootMoves(pos);
+
+			// the root probe is a tablebase hit like those in the search, counted once on the main thread
+			if (!m_rootMoves.empty())
+				++m_threads[0].search.tbhits;
+		}
+
 		m_limiter = std::move(limiter);
 
+		m_goTime = startTime;
+		m_stopTime.store(0.0, std::memory_order::relaxed);
+
 		m_stop.store(false, std::memory_order::seq_cst);
 		m_runningThreads.store(static_cast<i32>(m_threads.size()));
 
-		m_flag.store(SearchFlag, std::memory_order::seq_cst);
-		m_startSignal.notify_all();
+		startThreads(SearchFlag);
 	}
 
 	auto Searcher::stop() -> void
 	{
+		m_stopTime.store(util::g_timer.time(), std::memory_order::relaxed);
 		m_stop.store(true, std::memory_order::relaxed);
 		m_flag.store(IdleFlag, std::memory_order::seq_cst);
 
 		// safe, always runs from uci thread
-		if (m_runningThreads.load() > 0)
-		{
-			std::unique_lock lock{m_stopMutex};
-			m_stopSignal.wait(lock, [this]
-			{
-				return m_runningThreads.load(std::memory_order::seq_cst) == 0;
-			});
-		}
+		waitForThreads(m_runningThreads);
+	}
+
+	auto Searcher::takeFinishedSearch() -> std::optional<FinishedSearch>
+	{
+		std::unique_lock lock{m_searchMutex};
+		return std::exchange(m_finishedSearch, std::nullopt);
 	}
 
 	auto Searcher::runBench(BenchData &data, const Position &pos, i32 depth) -> void
 	{
 		m_limiter = std::make_unique<limit::InfiniteLimiter>();
 
-		// this struct is a small boulder the size of a large boulder
-		// and overflows the stack if not on the heap
-		auto threadData = std::make_unique<ThreadData>();
+		m_rootMoves.clear();
 
-		threadData->pos = pos;
-		threadData->maxDepth = depth;
+		for (auto &thread : m_threads)
+		{
+			thread.maxDepth = depth;
+			thread.search = SearchData{};
+			thread.nextLimiterCheck = 0;
+			thread.stats = SearchStats{};
+			thread.pos = pos;
+		}
 
 		m_stop.store(false, std::memory_order::seq_cst);
+		m_runningThreads.store(static_cast<i32>(m_threads.size()));
 
 		const auto start = util::g_timer.time();
 
-		searchRoot(*threadData, true);
+		startThreads(BenchFlag);
+		waitForThreads(m_runningThreads);
 
 		const auto time = util::g_timer.time() - start;
 
-		data.search = threadData->search;
+		setIdle();
+
+		data.search = m_threads[0].search;
+		data.search.nodes = 0;
+
 		data.time = time;
+
+		for (const auto &thread : m_threads)
+		{
+			data.search.nodes += thread.search.nodes;
+			data.search.seldepth = std::max(data.search.seldepth, thread.search.seldepth);
+
+			data.stats += thread.stats;
+
+			data.evalCacheProbes += thread.evalCache.probes();
+			data.evalCacheHits += thread.evalCache.hits();
+		}
+	}
+
+	auto Searcher::stats() const -> SearchStats
+	{
+		SearchStats total{};
+
+		for (const auto &thread : m_threads)
+		{
+			total += thread.stats;
+		}
+
+		return total;
 	}
 
 	auto Searcher::setThreads(u32 threads) -> void
@@ -220,6 +386,8 @@ namespace polaris::search
 		{
 			stopThreads();
 
+			// the new threads start counting from scratch
+			m_startGeneration = 0;
 			m_flag.store(IdleFlag, std::memory_order::seq_cst);
 
 			m_threads.clear();
@@ -233,6 +401,10 @@ namespace polaris::search
 				auto &threadData = m_threads.emplace_back();
 
 				threadData.id = m_nextThreadId++;
+
+				if (!m_sharedPawnCache)
+					threadData.pawnCache.resize(m_pawnCacheSize);
+
 				threadData.thread = std::thread{[this, &threadData]
 				{
 					run(threadData);
@@ -241,9 +413,72 @@ namespace polaris::search
 		}
 	}
 
+	auto Searcher::setPawnCacheSize(usize size) -> void
+	{
+		m_pawnCacheSize = size;
+
+		if (m_sharedPawnCache)
+			m_pawnCache.resize(size);
+		else
+		{
+			for (auto &thread : m_threads)
+			{
+				thread.pawnCache.resize(size);
+			}
+		}
+	}
+
+	auto Searcher::setSharedPawnCache(bool shared) -> void
+	{
+		if (shared == m_sharedPawnCache)
+			return;
+
+		m_sharedPawnCache = shared;
+
+		m_pawnCache.resize(shared ? m_pawnCacheSize : 0);
+
+		for (auto &thread : m_threads)
+		{
+			thread.pawnCache.resize(shared ? 0 : m_pawnCacheSize);
+		}
+	}
+
+	auto Searcher::startThreads(i32 flag) -> void
+	{
+		{
+			std::unique_lock lock{m_startMutex};
+
+			++m_startGeneration;
+			m_startFlag = flag;
+
+			m_flag.store(flag, std::memory_order::seq_cst);
+		}
+
+		m_startSignal.notify_all();
+	}
+
+	auto Searcher::waitForThreads(const std::atomic_int &count) -> void
+	{
+		std::unique_lock lock{m_stopMutex};
+		m_stopSignal.wait(lock, [&count]
+		{
+			return count.load(std::memory_order::seq_cst) == 0;
+		});
+	}
+
+	auto Searcher::setIdle() -> void
+	{
+		std::unique_lock lock{m_startMutex};
+		m_flag.store(IdleFlag, std::memory_order::seq_cst);
+	}
+
 	auto Searcher::stopThreads() -> void
 	{
-		m_flag.store(QuitFlag, std::memory_order::seq_cst);
+		{
+			std::unique_lock lock{m_startMutex};
+			m_flag.store(QuitFlag, std::memory_order::seq_cst);
+		}
+
 		m_startSignal.notify_all();
 
 		for (auto &thread : m_threads)
@@ -254,26 +489,60 @@ namespace polaris::search
 
 	auto Searcher::run(ThreadData &data) -> void
 	{
+		u32 generation{};
+
 		while (true)
 		{
 			i32 flag{};
 
 			{
 				std::unique_lock lock{m_startMutex};
-				m_startSignal.wait(lock, [this, &flag]
+				m_startSignal.wait(lock, [this, &flag, &generation]
 				{
+					// every start is picked up exactly once, even if
+					// the flag has already moved on by the time this
+					// thread wakes, or is still up when it gets back
+					if (generation != m_startGeneration)
+					{
+						generation = m_startGeneration;
+						flag = m_startFlag;
+						return true;
+					}
+
 					flag = m_flag.load(std::memory_order::seq_cst);
-					return flag != IdleFlag;
+					return flag == QuitFlag;
 				});
 			}
 
 			if (flag == QuitFlag)
 				return;
 
-			searchRoot(data, false);
+			if (flag == ClearFlag)
+			{
+				clearThreadData(data);
+
+				{
+					std::unique_lock lock{m_stopMutex};
+					--m_clearingThreads;
+				}
+
+				m_stopSignal.notify_all();
+
+				continue;
+			}
+
+			searchRoot(data, flag == BenchFlag);
 		}
 	}
 
+	auto Searcher::clearThreadData(ThreadData &data) -> void
+	{
+		data.pawnCache.clear();
+		data.evalCache.clear();
+		std::fill(data.stack.begin(), data.stack.end(), SearchStackEntry{});
+		data.history.clear();
+	}
+
 	auto Searcher::searchRoot(ThreadData &data, bool bench) -> void
 	{
 		auto &searchData = data.search;
@@ -292,7 +561,7 @@ namespace polaris::search
 
 		for (i32 depth = startDepth;
 			depth <= data.maxDepth
-				&& !(hitSoftTimeout = shouldStop(searchData, true));
+				&& !(hitSoftTimeout = shouldStop(data, true));
 			++depth)
 		{
 			searchData.depth = depth;
@@ -323,7 +592,7 @@ namespace polaris::search
 				auto alpha = std::max(score - delta, -ScoreMax);
 				auto beta  = std::min(score + delta,  ScoreMax);
 
-				while (!shouldStop(searchData, false))
+				while (!shouldStop(data, false))
 				{
 					aspDepth = std::max(aspDepth, depth - maxAspReduction());
 
@@ -371,7 +640,7 @@ namespace polaris::search
 			}
 
 			if (reportAndUpdate)
-				m_limiter->update(data.search, best, data.search.nodes);
+				m_limiter->update(data.search, score, best, data.search.nodes);
 
 			if (reportThisIter && depth < data.maxDepth)
 			{
@@ -388,32 +657,52 @@ namespace polaris::search
 
 		if (reportAndUpdate)
 		{
+			const auto endTime = util::g_timer.time();
+
 			if (!bench)
 				m_searchMutex.lock();
 
 			if (const auto move = best ?: searchData.move)
 			{
 				if (!hitSoftTimeout)
-					report(data, depthCompleted, move, util::g_timer.time() - startTime, score, -ScoreMax, ScoreMax);
+					report(data, depthCompleted, move, endTime - startTime, score, -ScoreMax, ScoreMax);
 				std::cout << "bestmove " << uci::moveToString(move) << std::endl;
 			}
 			else std::cout << "info string no legal moves" << std::endl;
+
+			// a stop that arrived after the search finished by itself cost nothing
+			auto stopTime = m_stopTime.load(std::memory_order::relaxed);
+			if (stopTime == 0.0 || stopTime > endTime)
+				stopTime = endTime;
+
+			m_finishedSearch = FinishedSearch{
+				.latency = (startTime - m_goTime) + (util::g_timer.time() - stopTime),
+				.nodes = searchData.nodes
+			};
 		}
 
 		if (!bench)
-		{
 			data.history.age();
+		// helpers only search for as long as the main thread in a bench
+		else if (data.id == 0)
+			m_stop.store(true, std::memory_order::relaxed);
 
+		// before the count drops, so that no thread touches the table once it's zero
+		if (reportAndUpdate)
+			m_table.age();
+
+		// under the mutex, or a waiting thread can miss the wakeup between checking and waiting
+		{
+			std::unique_lock lock{m_stopMutex};
 			--m_runningThreads;
-			m_stopSignal.notify_all();
+		}
 
-			if (reportAndUpdate)
-			{
-				m_table.age();
+		m_stopSignal.notify_all();
 
-				m_flag.store(IdleFlag, std::memory_order::relaxed);
-				m_searchMutex.unlock();
-			}
+		if (reportAndUpdate)
+		{
+			m_flag.store(IdleFlag, std::memory_order::relaxed);
+			m_searchMutex.unlock();
 		}
 	}
 
@@ -425,7 +714,7 @@ namespace polaris::search
 		assert(depth >= 0 && depth <= MaxDepth);
 		assert(ply   >= 0 && ply   <= MaxDepth);
 
-		if (depth > 1 && shouldStop(data.search, false))
+		if (depth > 1 && shouldStop(data, false))
 			return beta;
 
 		auto &pos = data.pos;
@@ -470,8 +759,17 @@ namespace polaris::search
 
 		if (!stack.excluded)
 		{
-			if (m_table.probe(entry, pos.key(), depth, ply, alpha, beta) && !pv)
+			const bool ttCutoff = m_table.probe(entry, pos.key(), depth, ply, alpha, beta);
+
+			countStat(data.stats.ttProbes);
+			if (entry.type != EntryType::None)
+				countStat(data.stats.ttHits);
+
+			if (ttCutoff && !pv)
+			{
+				countStat(data.stats.ttCutoffs);
 				return entry.score;
+			}
 			else if (entry.move && pos.isPseudolegal(entry.move))
 				ttMove = entry.move;
 
@@ -562,13 +860,15 @@ namespace polaris::search
 			}
 		}
 
-		if (!root && !pos.lastMove())
+		// the network is not symmetric, so only the hce can take the shortcut
+		if (!root && !pos.lastMove() && !pos.nnueEnabled())
 			stack.eval = eval::flipTempo(-data.stack[ply - 1].eval);
 		else if (stack.excluded)
 			stack.eval = data.stack[ply - 1].eval; // not prevStack
-		else stack.eval = inCheck ? 0 : eval::staticEval(pos, &data.pawnCache);
+		else stack.eval = inCheck ? 0 : eval::staticEval(pos, pawnCache(data), &data.evalCache);
 
 		stack.currMove = {};
+		stack.contEntry = nullptr;
 
 		const bool improving = !inCheck && ply > 1 && stack.eval > data.stack[ply - 2].eval;
 
@@ -577,7 +877,10 @@ namespace polaris::search
 			// reverse futility pruning
 			if (depth <= maxRfpDepth()
 				&& stack.eval >= beta + rfpMargin() * depth / (improving ? 2 : 1))
+			{
+				countStat(data.stats.rfpCutoffs);
 				return stack.eval;
+			}
 
 			// nullmove pruning
 			if (depth >= minNmpDepth()
@@ -591,11 +894,16 @@ namespace polaris::search
 						+ depth / nmpReductionDepthScale()
 						+ std::min((stack.eval - beta) / nmpReductionEvalScale(), maxNmpEvalReduction()));
 
+				countStat(data.stats.nmpAttempts);
+
 				const auto guard = pos.applyMove(NullMove, &m_table);
 				const auto score = -search(data, depth - R, ply + 1, moveStackIdx + 1, -beta, -beta + 1, !cutnode);
 
 				if (score >= beta)
+				{
+					countStat(data.stats.nmpCutoffs);
 					return score > ScoreWin ? beta : score;
+				}
 			}
 		}
 
@@ -605,7 +913,14 @@ namespace polaris::search
 		const i32 minLmrMoves = pv ? 3 : 2;
 
 		const auto prevMove = ply > 0 ? data.stack[ply - 1].currMove : HistoryMove{};
-		const auto prevPrevMove = ply > 1 ? data.stack[ply - 2].currMove : HistoryMove{};
+
+		ContinuationEntries conts{};
+
+		for (usize i = 0; i < ContinuationPlies.size(); ++i)
+		{
+			if (ply >= ContinuationPlies[i])
+				conts[i] = data.stack[ply - ContinuationPlies[i]].contEntry;
+		}
 
 		auto best = NullMove;
 		auto bestScore = -ScoreMax;
@@ -613,7 +928,7 @@ namespace polaris::search
 		auto entryType = EntryType::Alpha;
 
 		MoveGenerator generator{pos, stack.killer, moveStack.moves,
-			ttMove, prevMove, prevPrevMove, &data.history};
+			ttMove, prevMove, &conts, &data.history};
 
 		u32 legalMoves = 0;
 
@@ -622,6 +937,10 @@ namespace polaris::search
 			if (move == stack.excluded)
 				continue;
 
+			if (root && !m_rootMoves.empty()
+				&& std::ranges::find(m_rootMoves, move) == m_rootMoves.end())
+				continue;
+
 			const auto prevNodes = data.search.nodes;
 
 			const bool quietOrLosing = generator.stage() >= MovegenStage::Quiet;
@@ -636,12 +955,18 @@ namespace polaris::search
 					&& depth <= maxFpDepth()
 					&& alpha < ScoreWin
 					&& stack.eval + fpMargin() + std::max(0, depth - baseLmr) * fpScale() <= alpha)
+				{
+					countStat(data.stats.futilityPrunes);
 					break;
+				}
 
 				// see pruning
 				if (depth <= maxSeePruningDepth()
-					&& !see::see(pos, move, depth * (noisy ? noisySeeThreshold() : quietSeeThreshold())))
+					&& !generator.see(move, depth * (noisy ? noisySeeThreshold() : quietSeeThreshold())))
+				{
+					countStat(data.stats.seePrunes);
 					continue;
+				}
 			}
 
 			const auto movingPiece = boards.pieceAt(move.src());
@@ -654,7 +979,10 @@ namespace polaris::search
 			++data.search.nodes;
 			++legalMoves;
 
+			countStat(data.stats.searchNodes);
+
 			stack.currMove = {movingPiece, moveActualDst(move)};
+			stack.contEntry = &data.history.contEntry(stack.currMove);
 
 			i32 extension{};
 
@@ -688,10 +1016,16 @@ namespace polaris::search
 						reduction = std::clamp(lmr, 0, depth - 2);
 					}
 
+					if (reduction > 0)
+						countStat(data.stats.lmrSearches);
+
 					score = -search(data, newDepth - reduction, ply + 1, moveStackIdx + 1, -alpha - 1, -alpha, true);
 
 					if (score > alpha && reduction > 0)
+					{
+						countStat(data.stats.lmrResearches);
 						score = -search(data, newDepth, ply + 1, moveStackIdx + 1, -alpha - 1, -alpha, !cutnode);
+					}
 
 					if (score > alpha && score < beta)
 						score = -search(data, newDepth, ply + 1, moveStackIdx + 1, -beta, -alpha, false);
@@ -710,18 +1044,18 @@ namespace polaris::search
 				{
 					if (score >= beta)
 					{
-						const auto adjustment = depth * depth + depth - 1;
+						countStat(data.stats.betaCutoffs);
+						countStat(data.stats.cutoffsByStage[generator.stage()]);
+						if (legalMoves == 1)
+							countStat(data.stats.firstMoveCutoffs);
 
-						auto *prevContEntry = (quietOrLosing && prevMove)
-							? &data.history.contEntry(prevMove) : nullptr;
-						auto *prevPrevContEntry = (!noisy && prevPrevMove)
-							? &data.history.contEntry(prevPrevMove) : nullptr;
+						const auto adjustment = depth * depth + depth - 1;
 
 						if (quietOrLosing)
 						{
 							stack.killer = move;
 							if (prevMove)
-								data.history.entry(prevMove).countermove = move;
+								data.history.countermove(prevMove) = move;
 						}
 
 						if (noisy)
@@ -729,25 +1063,8 @@ namespace polaris::search
 								data.history.captureScore(stack.currMove, captured),
 								adjustment
 							);
-						else
-						{
-							updateHistoryScore(data.history.entry(stack.currMove).score, adjustment);
-
-							if (prevContEntry)
-								updateHistoryScore(prevContEntry->score(stack.currMove), adjustment);
-							if (prevPrevContEntry)
-								updateHistoryScore(prevPrevContEntry->score(stack.currMove), adjustment);
-
-							for (const auto prevQuiet : moveStack.quietsTried)
-							{
-								updateHistoryScore(data.history.entry(prevQuiet).score, -adjustment);
-
-								if (prevContEntry)
-									updateHistoryScore(prevContEntry->score(prevQuiet), -adjustment);
-								if (prevPrevContEntry)
-									updateHistoryScore(prevPrevContEntry->score(prevQuiet), -adjustment);
-							}
-						}
+						else data.history.updateQuiet(conts, stack.currMove,
+							{moveStack.quietsTried.begin(), moveStack.quietsTried.end()}, adjustment);
 
 						for (const auto [prevNoisy, prevCaptured] : moveStack.noisiesTried)
 						{
@@ -793,14 +1110,20 @@ namespace polaris::search
 
 	auto Searcher::qsearch(ThreadData &data, i32 ply, u32 moveStackIdx, Score alpha, Score beta) -> Score
 	{
-		if (shouldStop(data.search, false))
+		if (shouldStop(data, false))
 			return beta;
 
 		auto &pos = data.pos;
 
-		const auto staticEval = pos.isCheck()
-			? -ScoreMate
-			: eval::staticEval(pos, &data.pawnCache);
+		// stand pat only needs to know which side of the window the eval is on, the lazy
+		// eval is off by default until it has passed a strength test as it changes the bench
+		Score staticEval;
+
+		if (pos.isCheck())
+			staticEval = -ScoreMate;
+		else if (lazyQsearchEval() != 0)
+			staticEval = eval::staticEvalLazy(pos, alpha, beta, pawnCache(data), &data.evalCache);
+		else staticEval = eval::staticEval(pos, pawnCache(data), &data.evalCache);
 
 		if (staticEval > alpha)
 		{
@@ -842,6 +1165,8 @@ namespace polaris::search
 
 			++data.search.nodes;
 
+			countStat(data.stats.qsearchNodes);
+
 			const auto score = pos.isDrawn(false)
 				? drawScore(data.search.nodes)
 				: -qsearch(data, ply + 1, moveStackIdx + 1, -beta, -alpha);
@@ -870,22 +1195,18 @@ namespace polaris::search
 	}
 
 	auto Searcher::report(const ThreadData &data, i32 depth,
-		Move move, f64 time, Score score, Score alpha, Score beta, bool tbRoot) -> void
+		Move move, f64 time, Score score, Score alpha, Score beta) -> void
 	{
 		usize nodes = 0;
 
-		// in tb positions at root we have searched 0 nodes
-		if (!tbRoot)
+		// technically a potential race but it doesn't matter
+		for (const auto &thread: m_threads)
 		{
-			// technically a potential race but it doesn't matter
-			for (const auto &thread: m_threads)
-			{
-				nodes += thread.search.nodes;
-			}
+			nodes += thread.search.nodes;
 		}
 
-		const auto ms = tbRoot ? 0 : static_cast<usize>(time * 1000.0);
-		const auto nps = tbRoot ? 0 : static_cast<usize>(static_cast<f64>(nodes) / time);
+		const auto ms = static_cast<usize>(time * 1000.0);
+		const auto nps = static_cast<usize>(static_cast<f64>(nodes) / time);
 
 		std::cout << "info depth " << depth << " seldepth " << data.search.seldepth
 			<< " time " << ms << " nodes " << nodes << " nps " << nps << " score ";
@@ -919,9 +1240,6 @@ namespace polaris::search
 			std::cout << " wdl 1000 0 0";
 		else if (score < -ScoreWin)
 			std::cout << " wdl 0 0 1000";
-		// tablebase draws at the root
-		else if (tbRoot)
-			std::cout << " wdl 0 1000 0";
 		else
 		{
 			const auto plyFromStartpos = data.pos.fullmove() * 2 - (data.pos.toMove() == Color::White ? 1 : 0) - 1;
@@ -936,20 +1254,15 @@ namespace polaris::search
 
 		if (g_opts.syzygyEnabled)
 		{
-			if (tbRoot)
-				std::cout << " tbhits 1";
-			else
-			{
-				usize tbhits = 0;
+			usize tbhits = 0;
 
-				// technically a potential race but it doesn't matter
-				for (const auto &thread: m_threads)
-				{
-					tbhits += thread.search.tbhits;
-				}
-
-				std::cout << " tbhits " << tbhits;
+			// technically a potential race but it doesn't matter
+			for (const auto &thread: m_threads)
+			{
+				tbhits += thread.search.tbhits;
 			}
+
+			std::cout << " tbhits " << tbhits;
 		}
 
 		std::cout << " pv " << uci::moveToString(move);
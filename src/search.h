@@ -30,6 +30,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <vector>
+#include <array>
 
 #include "search_fwd.h"
 #include "position/position.h"
@@ -43,10 +44,56 @@ namespace polaris::search
 {
 	constexpr i32 MaxDepth = 255;
 
+#ifdef PS_SEARCH_STATS
+	constexpr bool StatsEnabled = true;
+#else
+	constexpr bool StatsEnabled = false;
+#endif
+
+	// tree shape counters, only touched when built with PS_SEARCH_STATS
+	struct SearchStats
+	{
+		usize searchNodes{};
+		usize qsearchNodes{};
+
+		usize ttProbes{};
+		usize ttHits{};
+		usize ttCutoffs{};
+
+		usize rfpCutoffs{};
+		usize nmpAttempts{};
+		usize nmpCutoffs{};
+		usize futilityPrunes{};
+		usize seePrunes{};
+
+		usize lmrSearches{};
+		usize lmrResearches{};
+
+		usize betaCutoffs{};
+		usize firstMoveCutoffs{};
+		std::array<usize, MovegenStage::End + 1> cutoffsByStage{};
+
+		auto operator+=(const SearchStats &other) -> SearchStats &;
+	};
+
+	auto printStats(const SearchStats &stats) -> void;
+
 	struct BenchData
 	{
 		SearchData search{};
+		SearchStats stats{};
 		f64 time{};
+
+		usize evalCacheProbes{};
+		usize evalCacheHits{};
+	};
+
+	struct FinishedSearch
+	{
+		// time spent outside of searching between go being received and bestmove being flushed
+		f64 latency;
+		// searched by the main thread, which is what limiters count
+		usize nodes;
 	};
 
 	constexpr u32 DefaultThreadCount = 1;
@@ -55,6 +102,9 @@ namespace polaris::search
 	constexpr auto SyzygyProbeDepthRange = util::Range<i32>{1, MaxDepth};
 	constexpr auto SyzygyProbeLimitRange = util::Range<i32>{0, 7};
 
+	// fills the lmr table, must be called before anything is searched
+	auto init() -> void;
+
 	class Searcher final
 	{
 	public:
@@ -68,11 +118,19 @@ namespace polaris::search
 
 		auto newGame() -> void;
 
-		auto startSearch(const Position &pos, i32 maxDepth, std::unique_ptr<limit::ISearchLimiter> limiter) -> void;
+		// startTime is when go was received
+		auto startSearch(const Position &pos, i32 maxDepth,
+			std::unique_ptr<limit::ISearchLimiter> limiter, f64 startTime) -> void;
 		auto stop() -> void;
 
+		// the last search, once per search and only once it is over
+		[[nodiscard]] auto takeFinishedSearch() -> std::optional<FinishedSearch>;
+
 		auto runBench(BenchData &data, const Position &pos, i32 depth) -> void;
 
+		// summed over all threads for the last search, only meaningful while idle
+		[[nodiscard]] auto stats() const -> SearchStats;
+
 		[[nodiscard]] inline auto searching() const
 		{
 			std::unique_lock lock{m_searchMutex};
@@ -81,6 +139,11 @@ namespace polaris::search
 
 		auto setThreads(u32 threads) -> void;
 
+		[[nodiscard]] inline auto threadCount() const
+		{
+			return static_cast<u32>(m_threads.size());
+		}
+
 		inline auto clearHash()
 		{
 			m_table.clear();
@@ -91,6 +154,10 @@ namespace polaris::search
 			m_table.resize(size);
 		}
 
+		// per thread, or in total if shared
+		auto setPawnCacheSize(usize size) -> void;
+		auto setSharedPawnCache(bool shared) -> void;
+
 		inline auto quit() -> void
 		{
 			m_quit = true;
@@ -103,6 +170,10 @@ namespace polaris::search
 		static constexpr i32 IdleFlag = 0;
 		static constexpr i32 SearchFlag = 1;
 		static constexpr i32 QuitFlag = 2;
+		// each thread clears its own tables
+		static constexpr i32 ClearFlag = 3;
+		// a search without reporting, for bench
+		static constexpr i32 BenchFlag = 4;
 
 		struct SearchStackEntry
 		{
@@ -110,6 +181,8 @@ namespace polaris::search
 
 			Score eval{};
 			HistoryMove currMove{};
+			// continuation entry for currMove, null for a null move
+			ContinuationEntry *contEntry{};
 			Move excluded{};
 		};
 
@@ -136,13 +209,20 @@ namespace polaris::search
 			i32 maxDepth{};
 			SearchData search{};
 
-			eval::PawnCache pawnCache{};
+			// main thread only
+			usize nextLimiterCheck{};
+
+			// allocated by the searcher, unused when the pawn cache is shared
+			eval::PawnCache pawnCache{0};
+			eval::EvalCache evalCache{};
 
 			std::vector<SearchStackEntry> stack{};
 			std::vector<MoveStackEntry> moveStack{};
 
 			HistoryTable history{};
 
+			SearchStats stats{};
+
 			Position pos{};
 		};
 
@@ -150,6 +230,11 @@ namespace polaris::search
 
 		TTable m_table{};
 
+		usize m_pawnCacheSize{eval::DefaultPawnCacheSize};
+		bool m_sharedPawnCache{false};
+
+		eval::PawnCache m_pawnCache{0};
+
 		u32 m_nextThreadId{};
 		std::vector<ThreadData> m_threads{};
 
@@ -158,26 +243,63 @@ namespace polaris::search
 		std::mutex m_startMutex{};
 		std::condition_variable m_startSignal{};
 		std::atomic_int m_flag{};
+		// bumped for every search, bench or clear, guarded by m_startMutex
+		u32 m_startGeneration{};
+		i32 m_startFlag{};
 
 		std::atomic_int m_stop{};
 
 		std::mutex m_stopMutex{};
 		std::condition_variable m_stopSignal{};
 		std::atomic_int m_runningThreads{};
+		std::atomic_int m_clearingThreads{};
 
 		std::unique_ptr<limit::ISearchLimiter> m_limiter{};
 
+		// moves the root is restricted to by a tablebase probe, read only while
+		// searching. empty if not in the tablebases, in which case all are searched
+		std::vector<Move> m_rootMoves{};
+
+		f64 m_goTime{};
+		// when the search was told to stop, zero if it ran to its depth limit
+		std::atomic<f64> m_stopTime{};
+		// guarded by m_searchMutex
+		std::optional<FinishedSearch> m_finishedSearch{};
+
+		auto startThreads(i32 flag) -> void;
+		auto waitForThreads(const std::atomic_int &count) -> void;
+		auto setIdle() -> void;
+
 		auto stopThreads() -> void;
 
+		auto clearThreadData(ThreadData &data) -> void;
+
+		[[nodiscard]] inline auto pawnCache(ThreadData &data)
+		{
+			return m_sharedPawnCache ? &m_pawnCache : &data.pawnCache;
+		}
+
 		auto run(ThreadData &data) -> void;
 
-		[[nodiscard]] inline auto shouldStop(const SearchData &data, bool allowSoftTimeout)
+		// only the main thread consults the limiter, as often as the limiter asks
+		// and at the start of each iteration - everything else only sees the flag
+		[[nodiscard]] inline auto shouldStop(ThreadData &data, bool allowSoftTimeout)
 		{
 			if (m_stop.load(std::memory_order::relaxed))
 				return true;
 
-			bool shouldStop = m_limiter->stop(data, allowSoftTimeout);
-			return m_stop.fetch_or(shouldStop, std::memory_order::relaxed) || shouldStop;
+			if (data.id != 0 || (!allowSoftTimeout && data.search.nodes < data.nextLimiterCheck))
+				return false;
+
+			if (!m_limiter->stop(data.search, allowSoftTimeout))
+			{
+				data.nextLimiterCheck = data.search.nodes + m_limiter->checkInterval(data.search);
+				return false;
+			}
+
+			m_stopTime.store(util::g_timer.time(), std::memory_order::relaxed);
+			m_stop.store(true, std::memory_order::relaxed);
+			return true;
 		}
 
 		auto searchRoot(ThreadData &data, bool bench) -> void;
@@ -187,6 +309,6 @@ namespace polaris::search
 		auto qsearch(ThreadData &data, i32 ply, u32 moveStackIdx, Score alpha, Score beta) -> Score;
 
 		auto report(const ThreadData &data, i32 depth, Move move,
-			f64 time, Score score, Score alpha, Score beta, bool tbRoot = false) -> void;
+			f64 time, Score score, Score alpha, Score beta) -> void;
 	};
 }
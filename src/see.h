@@ -21,10 +21,12 @@
 #include "types.h"
 
 #include <array>
+#include <algorithm>
 
 #include "core.h"
 #include "position/position.h"
 #include "attacks/attacks.h"
+#include "rays.h"
 
 namespace polaris::see
 {
@@ -129,6 +131,131 @@ namespace polaris::see
 		return BasePiece::None;
 	}
 
+	// pinned pieces that can't capture on a square without exposing their own king.
+	// a pin is released if the move being tested is made by its pinner, otherwise pins
+	// are taken to hold for the whole exchange even if the pinner is traded off
+	inline auto pinnedAway(const Position &pos, Move move)
+	{
+		Bitboard excluded{};
+
+		for (const auto color : {Color::Black, Color::White})
+		{
+			auto pinned = pos.pinned(color);
+
+			if (pinned.empty())
+				continue;
+
+			const auto king = pos.king(color);
+			const auto occupancy = pos.boards().occupancy();
+
+			while (pinned)
+			{
+				const auto square = pinned.popLowestSquare();
+
+				// captures along the pin line are fine
+				if (rayBetween(king, move.dst())[square] || rayBetween(king, square)[move.dst()])
+					continue;
+
+				// the pinner is the first piece past the pinned one, seen from the king,
+				// so anything further along the line moving doesn't release the pin
+				const bool pinnerMoving = rayBetween(king, move.src())[square]
+					&& (attacks::getRookAttacks(square, occupancy)
+						| attacks::getBishopAttacks(square, occupancy))[move.src()];
+
+				if (!pinnerMoving)
+					excluded |= squareBit(square);
+			}
+		}
+
+		return excluded;
+	}
+
+	// true if the move gains material even if the moving piece is then lost for nothing
+	inline auto winsOutright(const PositionBoards &boards, Move move)
+	{
+		const auto moving = move.type() == MoveType::Promotion
+			? move.target()
+			: basePiece(boards.pieceAt(move.src()));
+
+		return gain(boards, move) - value(moving) >= 0;
+	}
+
+	// the exact swap-off value of a move, for callers that want to test it against
+	// more than one threshold. value(pos, move) >= threshold iff see(pos, move, threshold)
+	inline auto value(const Position &pos, Move move) -> Score
+	{
+		const auto &boards = pos.boards();
+
+		// a capture can be answered at most once per remaining piece, plus the first capture
+		std::array<Score, 33> gains;
+		gains[0] = gain(boards, move);
+
+		i32 depth = 0;
+
+		auto next = move.type() == MoveType::Promotion
+			? move.target()
+			: basePiece(boards.pieceAt(move.src()));
+
+		const auto square = move.dst();
+
+		auto occupancy = boards.occupancy()
+			^ squareBit(move.src())
+			^ squareBit(square);
+
+		const auto queens = boards.queens();
+
+		const auto bishops = queens | boards.bishops();
+		const auto rooks = queens | boards.rooks();
+
+		// pinned pieces still block sliders behind them, so they stay in the occupancy
+		const auto unpinned = ~pinnedAway(pos, move);
+
+		auto attackers = pos.allAttackersTo(square, occupancy) & unpinned;
+
+		auto us = pos.opponent();
+
+		while (true)
+		{
+			const auto ourAttackers = attackers & boards.forColor(us);
+
+			if (ourAttackers.empty())
+				break;
+
+			const auto captured = next;
+			next = popLeastValuable(boards, occupancy, ourAttackers, us);
+
+			if (next == BasePiece::Pawn
+				|| next == BasePiece::Bishop
+				|| next == BasePiece::Queen)
+				attackers |= attacks::getBishopAttacks(square, occupancy) & bishops;
+
+			if (next == BasePiece::Rook
+				|| next == BasePiece::Queen)
+				attackers |= attacks::getRookAttacks(square, occupancy) & rooks;
+
+			attackers &= occupancy & unpinned;
+
+			// the king can't capture onto a defended square
+			if (next == BasePiece::King
+				&& !(attackers & boards.forColor(oppColor(us))).empty())
+				break;
+
+			++depth;
+			gains[depth] = value(captured) - gains[depth - 1];
+
+			us = oppColor(us);
+		}
+
+		// either side can decline to recapture
+		while (depth > 0)
+		{
+			gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+			--depth;
+		}
+
+		return gains[0];
+	}
+
 	// basically ported from ethereal and weiss (their implementation is the same)
 	inline auto see(const Position &pos, Move move, Score threshold = 0)
 	{
@@ -161,7 +288,9 @@ namespace polaris::see
 		const auto bishops = queens | boards.bishops();
 		const auto rooks = queens | boards.rooks();
 
-		auto attackers = pos.allAttackersTo(square, occupancy);
+		const auto unpinned = ~pinnedAway(pos, move);
+
+		auto attackers = pos.allAttackersTo(square, occupancy) & unpinned;
 
 		auto us = oppColor(color);
 
@@ -183,7 +312,7 @@ namespace polaris::see
 				|| next == BasePiece::Queen)
 				attackers |= attacks::getRookAttacks(square, occupancy) & rooks;
 
-			attackers &= occupancy;
+			attackers &= occupancy & unpinned;
 
 			score = -score - 1 - value(next);
 			us = oppColor(us);
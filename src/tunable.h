@@ -61,6 +61,25 @@ namespace polaris::tunable
 		constexpr Score FpScale = 60;
 
 		constexpr i32 MinIirDepth = 4;
+
+		// nonzero enables the lazy stand pat eval in qsearch
+		constexpr i32 LazyQsearchEval = 0;
+		constexpr Score LazyEvalMargin = 500;
+
+		// time management scales are in percent
+		constexpr i32 TmNodeFractionBase = 150;
+		constexpr i32 TmNodeFractionScale = 135;
+
+		// the stability and score change scales are neutral (1.0)
+		// by default until they have been fitted and tested
+		constexpr i32 TmStabilityBase = 100;
+		constexpr i32 TmStabilityStep = 0;
+		constexpr i32 TmMaxStability = 5;
+
+		// per 10 cp of score change since the previous iteration
+		constexpr i32 TmScoreDeltaScale = 0;
+		constexpr i32 TmMinScoreScale = 80;
+		constexpr i32 TmMaxScoreScale = 150;
 	}
 
 	struct TunableData
@@ -100,6 +119,20 @@ namespace polaris::tunable
 		Score fpScale{defaults::FpScale};
 
 		i32 minIirDepth{defaults::MinIirDepth};
+
+		i32 lazyQsearchEval{defaults::LazyQsearchEval};
+		Score lazyEvalMargin{defaults::LazyEvalMargin};
+
+		i32 tmNodeFractionBase{defaults::TmNodeFractionBase};
+		i32 tmNodeFractionScale{defaults::TmNodeFractionScale};
+
+		i32 tmStabilityBase{defaults::TmStabilityBase};
+		i32 tmStabilityStep{defaults::TmStabilityStep};
+		i32 tmMaxStability{defaults::TmMaxStability};
+
+		i32 tmScoreDeltaScale{defaults::TmScoreDeltaScale};
+		i32 tmMinScoreScale{defaults::TmMinScoreScale};
+		i32 tmMaxScoreScale{defaults::TmMaxScoreScale};
 	};
 
 #if PS_TUNE_SEARCH
@@ -146,5 +179,19 @@ namespace polaris::tunable
 
 	PS_TUNABLE_PARAM(MinIirDepth, minIirDepth)
 
+	PS_TUNABLE_PARAM(LazyQsearchEval, lazyQsearchEval)
+	PS_TUNABLE_PARAM(LazyEvalMargin, lazyEvalMargin)
+
+	PS_TUNABLE_PARAM(TmNodeFractionBase, tmNodeFractionBase)
+	PS_TUNABLE_PARAM(TmNodeFractionScale, tmNodeFractionScale)
+
+	PS_TUNABLE_PARAM(TmStabilityBase, tmStabilityBase)
+	PS_TUNABLE_PARAM(TmStabilityStep, tmStabilityStep)
+	PS_TUNABLE_PARAM(TmMaxStability, tmMaxStability)
+
+	PS_TUNABLE_PARAM(TmScoreDeltaScale, tmScoreDeltaScale)
+	PS_TUNABLE_PARAM(TmMinScoreScale, tmMinScoreScale)
+	PS_TUNABLE_PARAM(TmMaxScoreScale, tmMaxScoreScale)
+
 #undef PS_TUNABLE_PARAM
 }
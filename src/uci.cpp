@@ -35,6 +35,7 @@
 #include "search.h"
 #include "movegen.h"
 #include "eval/eval.h"
+#include "eval/nnue.h"
 #include "pretty.h"
 #include "ttable.h"
 #include "limit/trivial.h"
@@ -85,7 +86,12 @@ namespace polaris
 			auto handleMoves() -> void;
 			auto handlePerft(const std::vector<std::string> &tokens) -> void;
 			auto handleSplitperft(const std::vector<std::string> &tokens) -> void;
-			auto handleBench(const std::vector<std::string> &tokens) -> void;
+			auto handlePerftsuite() -> void;
+			auto handleBench(const std::vector<std::string> &tokens, bool json) -> void;
+			auto handleEvalbench(const std::vector<std::string> &tokens) -> void;
+			auto handleAttackbench(const std::vector<std::string> &tokens) -> void;
+			auto handleSeetest() -> void;
+			auto handleSearchstats() -> void;
 #ifndef NDEBUG
 			auto handleVerify() -> void;
 #endif
@@ -97,6 +103,21 @@ namespace polaris
 			Position m_pos{Position::starting()};
 
 			i32 m_moveOverhead{limit::DefaultMoveOverhead};
+
+			bool m_autoMoveOverhead{false};
+			limit::OverheadTracker m_overheadTracker{};
+			i32 m_reportedOverhead{-1};
+
+			i64 m_nodesTime{};
+			// the gui's clock runs on wall time, so with nodestime the budget
+			// is kept here instead, from the first move of each game
+			std::optional<i64> m_availableNodes{};
+			i64 m_nodesTimeIncrement{};
+			bool m_nodesTimeSearch{false};
+
+			// takes the last search's latency and nodes into account
+			auto recordFinishedSearch() -> void;
+			auto currentMoveOverhead() -> i32;
 		};
 
 		UciHandler::~UciHandler()
@@ -150,8 +171,20 @@ namespace polaris
 					handlePerft(tokens);
 				else if (command == "splitperft")
 					handleSplitperft(tokens);
+				else if (command == "perftsuite")
+					handlePerftsuite();
 				else if (command == "bench")
-					handleBench(tokens);
+					handleBench(tokens, false);
+				else if (command == "jsonbench")
+					handleBench(tokens, true);
+				else if (command == "evalbench")
+					handleEvalbench(tokens);
+				else if (command == "attackbench")
+					handleAttackbench(tokens);
+				else if (command == "seetest")
+					handleSeetest();
+				else if (command == "searchstats")
+					handleSearchstats();
 #ifndef NDEBUG
 				else if (command == "verify")
 					handleVerify();
@@ -171,6 +204,9 @@ namespace polaris
 			std::cout << "option name Hash type spin default " << DefaultHashSize
 				<< " min " << HashSizeRange.min() << " max " << HashSizeRange.max() << '\n';
 			std::cout << "option name Clear Hash type button\n";
+			std::cout << "option name Pawn Hash type spin default " << eval::DefaultPawnCacheSize
+				<< " min " << eval::PawnCacheSizeRange.min() << " max " << eval::PawnCacheSizeRange.max() << '\n';
+			std::cout << "option name Shared Pawn Hash type check default false\n";
 			std::cout << "option name Threads type spin default " << search::DefaultThreadCount
 				<< " min " << search::ThreadCountRange.min() << " max " << search::ThreadCountRange.max() << '\n';
 			//TODO
@@ -179,6 +215,9 @@ namespace polaris
 				<< (defaultOpts.chess960 ? "true" : "false") << '\n';
 			std::cout << "option name Move Overhead type spin default " << limit::DefaultMoveOverhead
 				<< " min " << limit::MoveOverheadRange.min() << " max " << limit::MoveOverheadRange.max() << '\n';
+			std::cout << "option name Auto Move Overhead type check default false\n";
+			std::cout << "option name NodesTime type spin default 0 min "
+				<< limit::NodesTimeRange.min() << " max " << limit::NodesTimeRange.max() << '\n';
 			std::cout << "option name SyzygyPath type string default <empty>\n";
 			std::cout << "option name SyzygyProbeDepth type spin default " << defaultOpts.syzygyProbeDepth
 				<< " min " << search::SyzygyProbeDepthRange.min()
@@ -186,6 +225,9 @@ namespace polaris
 			std::cout << "option name SyzygyProbeLimit type spin default " << defaultOpts.syzygyProbeLimit
 				<< " min " << search::SyzygyProbeLimitRange.min()
 				<< " max " << search::SyzygyProbeLimitRange.max() << '\n';
+			std::cout << "option name UseNNUE type check default "
+				<< (defaultOpts.useNnue ? "true" : "false") << '\n';
+			std::cout << "option name EvalFile type string default <empty>\n";
 
 			std::cout << "uciok" << std::endl;
 		}
@@ -194,7 +236,11 @@ namespace polaris
 		{
 			if (m_searcher.searching())
 				std::cerr << "still searching" << std::endl;
-			else m_searcher.newGame();
+			else
+			{
+				m_searcher.newGame();
+				m_availableNodes = {};
+			}
 		}
 
 		auto UciHandler::handleIsready() -> void
@@ -259,6 +305,9 @@ namespace polaris
 
 				const auto startTime = util::g_timer.time();
 
+				recordFinishedSearch();
+				const auto moveOverhead = currentMoveOverhead();
+
 				i64 timeRemaining{};
 				i64 increment{};
 				i32 toGo{};
@@ -292,7 +341,10 @@ namespace polaris
 							else
 							{
 								time = std::max<i64>(time, 1);
-								limiter = std::make_unique<limit::MoveTimeLimiter>(time, m_moveOverhead);
+
+								if (m_nodesTime > 0)
+									limiter = std::make_unique<limit::NodeLimiter>(static_cast<usize>(time * m_nodesTime));
+								else limiter = std::make_unique<limit::MoveTimeLimiter>(time, moveOverhead);
 							}
 						}
 						else if ((tokens[i] == "btime" || tokens[i] == "wtime") && ++i < tokens.size()
@@ -383,16 +435,71 @@ namespace polaris
 				else if (depth > search::MaxDepth)
 					depth = search::MaxDepth;
 
-				if (tournamentTime && timeRemaining > 0)
+				if (tournamentTime && timeRemaining > 0 && m_nodesTime > 0)
+				{
+					if (!m_availableNodes)
+						m_availableNodes = timeRemaining * m_nodesTime;
+
+					m_nodesTimeIncrement = increment * m_nodesTime;
+					m_nodesTimeSearch = true;
+
+					// no overhead, nothing is lost to the clock
+					limiter = std::make_unique<limit::TimeManager>(startTime,
+						static_cast<f64>(*m_availableNodes) / static_cast<f64>(m_nodesTime) / 1000.0,
+						static_cast<f64>(increment) / 1000.0,
+						toGo, 0.0, m_nodesTime);
+				}
+				else if (tournamentTime && timeRemaining > 0)
 					limiter = std::make_unique<limit::TimeManager>(startTime,
 						static_cast<f64>(timeRemaining) / 1000.0,
 						static_cast<f64>(increment) / 1000.0,
-						toGo, static_cast<f64>(m_moveOverhead) / 1000.0);
+						toGo, static_cast<f64>(moveOverhead) / 1000.0);
 				else if (!limiter)
 					limiter = std::make_unique<limit::InfiniteLimiter>();
 
-				m_searcher.startSearch(m_pos, static_cast<i32>(depth), std::move(limiter));
+				m_searcher.startSearch(m_pos, static_cast<i32>(depth), std::move(limiter), startTime);
+			}
+		}
+
+		auto UciHandler::recordFinishedSearch() -> void
+		{
+			const auto finished = m_searcher.takeFinishedSearch();
+
+			if (!finished)
+				return;
+
+			m_overheadTracker.addSample(finished->latency);
+
+			if (m_nodesTimeSearch && m_availableNodes)
+				m_availableNodes = std::max<i64>(0,
+					*m_availableNodes + m_nodesTimeIncrement - static_cast<i64>(finished->nodes));
+
+			m_nodesTimeSearch = false;
+		}
+
+		auto UciHandler::currentMoveOverhead() -> i32
+		{
+			if (!m_autoMoveOverhead)
+				return m_moveOverhead;
+
+			const auto overhead = m_overheadTracker.overhead();
+
+			if (!overhead)
+				return m_moveOverhead;
+
+			// only ever raises the margin, the measured latency misses delays outside the engine
+			const auto effective = std::max(m_moveOverhead, *overhead);
+
+			if (effective != m_reportedOverhead)
+			{
+				std::cout << "info string move overhead " << effective << " ms (measured " << *overhead
+					<< " ms, at least Move Overhead " << m_moveOverhead << " ms), 95th percentile latency "
+					<< (m_overheadTracker.percentile() * 1000.0) << " ms over the last "
+					<< m_overheadTracker.sampleCount() << " searches" << std::endl;
+				m_reportedOverhead = effective;
 			}
+
+			return effective;
 		}
 
 		auto UciHandler::handleStop() -> void
@@ -463,6 +570,28 @@ namespace polaris
 
 					m_searcher.clearHash();
 				}
+				else if (nameStr == "pawn hash")
+				{
+					if (m_searcher.searching())
+						std::cerr << "still searching" << std::endl;
+
+					if (!valueEmpty)
+					{
+						if (const auto newPawnHashSize = util::tryParseSize(valueStr))
+							m_searcher.setPawnCacheSize(eval::PawnCacheSizeRange.clamp(*newPawnHashSize));
+					}
+				}
+				else if (nameStr == "shared pawn hash")
+				{
+					if (m_searcher.searching())
+						std::cerr << "still searching" << std::endl;
+
+					if (!valueEmpty)
+					{
+						if (const auto newSharedPawnHash = util::tryParseBool(valueStr))
+							m_searcher.setSharedPawnCache(*newSharedPawnHash);
+					}
+				}
 				else if (nameStr == "threads")
 				{
 					if (m_searcher.searching())
@@ -490,6 +619,28 @@ namespace polaris
 							m_moveOverhead = limit::MoveOverheadRange.clamp(*newMoveOverhead);
 					}
 				}
+				else if (nameStr == "nodestime")
+				{
+					if (!valueEmpty)
+					{
+						if (const auto newNodesTime = util::tryParseI64(valueStr))
+						{
+							m_nodesTime = limit::NodesTimeRange.clamp(*newNodesTime);
+							m_availableNodes = {};
+						}
+					}
+				}
+				else if (nameStr == "auto move overhead")
+				{
+					if (!valueEmpty)
+					{
+						if (const auto newAutoMoveOverhead = util::tryParseBool(valueStr))
+						{
+							m_autoMoveOverhead = *newAutoMoveOverhead;
+							m_reportedOverhead = -1;
+						}
+					}
+				}
 				else if (nameStr == "syzygypath")
 				{
 					if (m_searcher.searching())
@@ -509,6 +660,43 @@ namespace polaris
 							std::cerr << "failed to initialize Fathom" << std::endl;
 					}
 				}
+				else if (nameStr == "usennue")
+				{
+					if (m_searcher.searching())
+						std::cerr << "still searching" << std::endl;
+
+					if (!valueEmpty)
+					{
+						if (const auto newUseNnue = util::tryParseBool(valueStr))
+						{
+							if (*newUseNnue && !eval::nnue::networkLoaded())
+								std::cerr << "no network loaded" << std::endl;
+							else
+							{
+								s_opts.useNnue = *newUseNnue;
+								m_pos.setNnue(s_opts.useNnue);
+							}
+						}
+					}
+				}
+				else if (nameStr == "evalfile")
+				{
+					if (m_searcher.searching())
+						std::cerr << "still searching" << std::endl;
+
+					if (!valueEmpty && valueStr != "<empty>")
+					{
+						if (eval::nnue::loadNetwork(valueStr))
+						{
+							std::cout << "info string loaded network " << valueStr << std::endl;
+
+							// accumulators are stale with the new weights
+							if (s_opts.useNnue)
+								m_pos.setNnue(true);
+						}
+						else std::cerr << "failed to load network " << valueStr << std::endl;
+					}
+				}
 				else if (nameStr == "syzygyprobedepth")
 				{
 					if (!valueEmpty)
@@ -636,6 +824,56 @@ namespace polaris
 					if (!valueEmpty)
 						util::tryParseI32(s_tunable.minIirDepth, valueStr);
 				}
+				else if (nameStr == "lazyqsearcheval")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.lazyQsearchEval, valueStr);
+				}
+				else if (nameStr == "lazyevalmargin")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.lazyEvalMargin, valueStr);
+				}
+				else if (nameStr == "tmnodefractionbase")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmNodeFractionBase, valueStr);
+				}
+				else if (nameStr == "tmnodefractionscale")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmNodeFractionScale, valueStr);
+				}
+				else if (nameStr == "tmstabilitybase")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmStabilityBase, valueStr);
+				}
+				else if (nameStr == "tmstabilitystep")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmStabilityStep, valueStr);
+				}
+				else if (nameStr == "tmmaxstability")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmMaxStability, valueStr);
+				}
+				else if (nameStr == "tmscoredeltascale")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmScoreDeltaScale, valueStr);
+				}
+				else if (nameStr == "tmminscorescale")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmMinScoreScale, valueStr);
+				}
+				else if (nameStr == "tmmaxscorescale")
+				{
+					if (!valueEmpty)
+						util::tryParseI32(s_tunable.tmMaxScoreScale, valueStr);
+				}
 #endif
 			}
 		}
@@ -715,7 +953,30 @@ namespace polaris
 				}
 			}
 
-			perft(m_pos, static_cast<i32>(depth));
+			u32 threads = 1;
+
+			if (tokens.size() > 2)
+			{
+				if (!util::tryParseU32(threads, tokens[2]))
+				{
+					std::cerr << "invalid thread count " << tokens[2] << std::endl;
+					return;
+				}
+			}
+
+			usize hash = 0;
+
+			if (tokens.size() > 3)
+			{
+				if (!util::tryParseSize(hash, tokens[3]))
+				{
+					std::cerr << "invalid hash size " << tokens[3] << std::endl;
+					return;
+				}
+			}
+
+			perft(m_pos, static_cast<i32>(depth),
+				PerftThreadsRange.clamp(threads), PerftHashSizeRange.clamp(hash));
 		}
 
 		auto UciHandler::handleSplitperft(const std::vector<std::string> &tokens) -> void
@@ -731,10 +992,45 @@ namespace polaris
 				}
 			}
 
-			splitPerft(m_pos, static_cast<i32>(depth));
+			u32 threads = 1;
+
+			if (tokens.size() > 2)
+			{
+				if (!util::tryParseU32(threads, tokens[2]))
+				{
+					std::cerr << "invalid thread count " << tokens[2] << std::endl;
+					return;
+				}
+			}
+
+			usize hash = 0;
+
+			if (tokens.size() > 3)
+			{
+				if (!util::tryParseSize(hash, tokens[3]))
+				{
+					std::cerr << "invalid hash size " << tokens[3] << std::endl;
+					return;
+				}
+			}
+
+			splitPerft(m_pos, static_cast<i32>(depth),
+				PerftThreadsRange.clamp(threads), PerftHashSizeRange.clamp(hash));
 		}
 
-		auto UciHandler::handleBench(const std::vector<std::string> &tokens) -> void
+		auto UciHandler::handlePerftsuite() -> void
+		{
+			// the suite flips chess960 on and off
+			if (m_searcher.searching())
+			{
+				std::cerr << "already searching" << std::endl;
+				return;
+			}
+
+			perftSuite();
+		}
+
+		auto UciHandler::handleBench(const std::vector<std::string> &tokens, bool json) -> void
 		{
 			if (m_searcher.searching())
 			{
@@ -743,8 +1039,11 @@ namespace polaris
 			}
 
 			i32 depth = bench::DefaultBenchDepth;
+			u32 threads = 1;
 			usize hash = 16;
 
+			std::vector<std::string> fens{};
+
 			if (tokens.size() > 1)
 			{
 				if (const auto newDepth = util::tryParseU32(tokens[1]))
@@ -759,10 +1058,7 @@ namespace polaris
 			if (tokens.size() > 2)
 			{
 				if (const auto newThreads = util::tryParseU32(tokens[2]))
-				{
-					if (*newThreads > 1)
-						std::cout << "info string multiple search threads not yet supported, using 1" << std::endl;
-				}
+					threads = search::ThreadCountRange.clamp(*newThreads);
 				else
 				{
 					std::cout << "info string invalid thread count " << tokens[2] << std::endl;
@@ -781,13 +1077,99 @@ namespace polaris
 				}
 			}
 
+			if (tokens.size() > 4)
+			{
+				// the rest of the line, so that paths can contain spaces
+				auto path = tokens[4];
+				for (usize i = 5; i < tokens.size(); ++i)
+				{
+					path += ' ' + tokens[i];
+				}
+
+				if (auto loaded = bench::loadPositions(path); loaded && !loaded->empty())
+					fens = std::move(*loaded);
+				else
+				{
+					std::cout << "info string no positions loaded from " << path << std::endl;
+					return;
+				}
+			}
+
+			// the pool is put back afterwards, the gui still expects its own thread count
+			const auto prevThreads = m_searcher.threadCount();
+
 			m_searcher.setHashSize(hash);
-			std::cout << "info string set hash size to " << hash << std::endl;
+			m_searcher.setThreads(threads);
+
+			// json output has to be the only thing printed
+			if (!json)
+			{
+				std::cout << "info string set hash size to " << hash << std::endl;
+				std::cout << "info string set thread count to " << threads << std::endl;
+			}
 
 			if (depth == 0)
 				depth = 1;
 
-			bench::run(m_searcher, depth);
+			bench::run(m_searcher, depth, fens, json);
+
+			m_searcher.setThreads(prevThreads);
+		}
+
+		auto UciHandler::handleEvalbench(const std::vector<std::string> &tokens) -> void
+		{
+			if (m_searcher.searching())
+			{
+				std::cerr << "already searching" << std::endl;
+				return;
+			}
+
+			u32 iterations = bench::DefaultEvalBenchIterations;
+
+			if (tokens.size() > 1)
+			{
+				if (const auto newIterations = util::tryParseU32(tokens[1]))
+					iterations = std::max<u32>(*newIterations, 1);
+				else
+				{
+					std::cout << "info string invalid iteration count " << tokens[1] << std::endl;
+					return;
+				}
+			}
+
+			bench::runEval(iterations);
+		}
+
+		auto UciHandler::handleAttackbench(const std::vector<std::string> &tokens) -> void
+		{
+			u32 iterations = bench::DefaultAttackBenchIterations;
+
+			if (tokens.size() > 1)
+			{
+				if (const auto newIterations = util::tryParseU32(tokens[1]))
+					iterations = std::max<u32>(*newIterations, 1);
+				else
+				{
+					std::cout << "info string invalid iteration count " << tokens[1] << std::endl;
+					return;
+				}
+			}
+
+			bench::runAttacks(iterations);
+		}
+
+		auto UciHandler::handleSeetest() -> void
+		{
+			bench::runSee();
+		}
+
+		auto UciHandler::handleSearchstats() -> void
+		{
+			if constexpr (!search::StatsEnabled)
+				std::cout << "info string built without PS_SEARCH_STATS" << std::endl;
+			else if (m_searcher.searching())
+				std::cerr << "still searching" << std::endl;
+			else search::printStats(m_searcher.stats());
 		}
 
 #ifndef NDEBUG
@@ -801,6 +1183,11 @@ namespace polaris
 
 	const GlobalOptions &g_opts = s_opts;
 
+	auto mutableOpts() -> GlobalOptions &
+	{
+		return s_opts;
+	}
+
 #if PS_TUNE_SEARCH
 	namespace tunable
 	{
@@ -157,7 +157,7 @@ namespace polaris::util
 		if (std::is_constant_evaluated())
 			return fallback::pext(v, mask);
 
-		return _pext_u64(v, mask);
+		return static_cast<u64>(_pext_u64(v, mask));
 #else
 		return fallback::pext(v, mask);
 #endif
@@ -169,7 +169,7 @@ namespace polaris::util
 		if (std::is_constant_evaluated())
 			return fallback::pdep(v, mask);
 
-		return _pdep_u64(v, mask);
+		return static_cast<u64>(_pdep_u64(v, mask));
 #else
 		return fallback::pdep(v, mask);
 #endif
@@ -30,7 +30,7 @@ namespace polaris
 	public:
 		using result_type = u64;
 
-		explicit inline Jsf64Rng(u64 seed)
+		explicit constexpr Jsf64Rng(u64 seed)
 			: m_b{seed}, m_c{seed}, m_d{seed}
 		{
 			for (usize i = 0; i < 20; ++i)
@@ -41,7 +41,7 @@ namespace polaris
 
 		~Jsf64Rng() = default;
 
-		inline auto nextU64() -> u64
+		constexpr auto nextU64() -> u64
 		{
 			const auto e = m_a - std::rotl(m_b, 7);
 			m_a = m_b ^ std::rotl(m_c, 13);
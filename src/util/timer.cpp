@@ -24,22 +24,16 @@
 
 namespace polaris::util
 {
-	Timer::Timer()
+	auto Timer::time() const -> f64
 	{
+		// fixed at boot, and cheap to query
 		u64 freq{};
 		QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER *>(&freq));
 
-		m_frequency = static_cast<f64>(freq);
-
-		QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER *>(&m_initTime));
-	}
-
-	auto Timer::time() const -> f64
-	{
 		u64 time{};
 		QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER *>(&time));
 
-		return static_cast<f64>(time - m_initTime) / m_frequency;
+		return static_cast<f64>(time) / static_cast<f64>(freq);
 	}
 
 	auto Timer::roughTimeMs() -> i64
@@ -52,20 +46,12 @@ namespace polaris::util
 
 namespace polaris::util
 {
-	Timer::Timer()
-	{
-		struct timespec time;
-		clock_gettime(CLOCK_MONOTONIC, &time);
-
-		m_initTime = static_cast<f64>(time.tv_sec) + static_cast<f64>(time.tv_nsec) / 1000000000.0;
-	}
-
 	auto Timer::time() const -> f64
 	{
 		struct timespec time{};
 		clock_gettime(CLOCK_MONOTONIC, &time);
 
-		return (static_cast<f64>(time.tv_sec) + static_cast<f64>(time.tv_nsec) / 1000000000.0) - m_initTime;
+		return static_cast<f64>(time.tv_sec) + static_cast<f64>(time.tv_nsec) / 1000000000.0;
 	}
 }
 #endif
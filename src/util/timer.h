@@ -22,23 +22,17 @@
 
 namespace polaris::util
 {
+	// stateless, so that g_timer needs no initialiser that runs before polaris-auto has
+	// checked the cpu. Times are from an arbitrary point, only differences are meaningful
 	class Timer
 	{
 	public:
-		Timer();
+		Timer() = default;
 		~Timer() = default;
 
 		[[nodiscard]] auto time() const -> f64;
 
 		[[nodiscard]] static auto roughTimeMs() -> i64;
-
-	private:
-#ifdef _WIN32
-		u64 m_initTime{};
-		f64 m_frequency;
-#else
-		f64 m_initTime;
-#endif
 	};
 
 	inline const Timer g_timer{};